@@ -0,0 +1,281 @@
+/*
+  genboard.cpp
+
+  Copyright (c) 2011, Jeremiah LaRocco jeremiah.larocco@gmail.com
+
+  Permission to use, copy, modify, and/or distribute this software for any
+  purpose with or without fee is hereby granted, provided that the above
+  copyright notice and this permission notice appear in all copies.
+
+  THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+  WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+  MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+  ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+  WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+  ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+  OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+
+// The SSE2 kernel is built with a target attribute so 32-bit builds
+// without -msse2 still get it on CPUs that have it
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define GEN_X86_KERNELS
+#include <emmintrin.h>
+#endif
+
+#include <algorithm>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "genboard.h"
+
+#include "lifeparallel.h"
+
+bool GenRule::parse(const char *text) {
+    // The number of states is after the last slash, with or without a C
+    const char *slash = strrchr(text, '/');
+    if (!slash) {
+        return false;
+    }
+    const char *c = slash + 1;
+    if (*c == 'C' || *c == 'c') {
+        ++c;
+    }
+    if (*c < '0' || *c > '9') {
+        return false;
+    }
+    char *end;
+    long numStates = strtol(c, &end, 10);
+    if (*end != '\0' || numStates < 2 || numStates > MAX_STATES) {
+        return false;
+    }
+
+    GenRule rule;
+    std::string lifePart(text, slash - text);
+    if (!rule.life.parse(lifePart.c_str())) {
+        return false;
+    }
+    rule.states = int(numStates);
+    *this = rule;
+    return true;
+}
+
+std::string GenRule::toString() const {
+    char text[16];
+    snprintf(text, sizeof(text), "/C%d", states);
+    return life.toString() + text;
+}
+
+/*
+  Everything a row kernel needs to know about the rule, in the form it
+  wants it.
+*/
+struct GenKernelRule {
+    unsigned int birth, survive;
+    unsigned char states;
+    const unsigned char *born;
+    const unsigned char *survivor;
+    const unsigned char *decay;
+};
+
+static inline int liveCount(const unsigned char *up, const unsigned char *cur,
+                            const unsigned char *down, int west, int east, int j) {
+    return (up[west] == 1) + (up[j] == 1) + (up[east] == 1) +
+        (cur[west] == 1) + (cur[east] == 1) +
+        (down[west] == 1) + (down[j] == 1) + (down[east] == 1);
+}
+
+static inline unsigned char nextState(unsigned char state, int num, const GenKernelRule &rule) {
+    if (state == 0) {
+        return rule.born[num];
+    }
+    if (state == 1) {
+        return rule.survivor[num];
+    }
+    return rule.decay[state];
+}
+
+/*
+  Evolves cells [begin, end) of one row.  Every cell in the range needs a
+  neighbor on both sides, so the first and last cell are left to the
+  caller.
+*/
+typedef void (*GenRowKernel)(const unsigned char *up, const unsigned char *cur,
+                             const unsigned char *down, unsigned char *out,
+                             int begin, int end, const GenKernelRule &rule);
+
+static void scalarGenRow(const unsigned char *up, const unsigned char *cur,
+                         const unsigned char *down, unsigned char *out,
+                         int begin, int end, const GenKernelRule &rule) {
+    for (int j=begin; j<end; ++j) {
+        out[j] = nextState(cur[j], liveCount(up, cur, down, j-1, j+1, j), rule);
+    }
+}
+
+#ifdef GEN_X86_KERNELS
+
+__attribute__((target("sse2")))
+static inline __m128i liveBytes(const unsigned char *p, __m128i one) {
+    // 1 where the state is 1, else 0
+    return _mm_and_si128(_mm_cmpeq_epi8(_mm_loadu_si128((const __m128i *)p), one), one);
+}
+
+__attribute__((target("sse2")))
+static inline __m128i countIn(__m128i count, unsigned int mask) {
+    __m128i hit = _mm_setzero_si128();
+    for (int n=0; n<=8; ++n) {
+        if (mask & (1u << n)) {
+            hit = _mm_or_si128(hit, _mm_cmpeq_epi8(count, _mm_set1_epi8(char(n))));
+        }
+    }
+    return hit;
+}
+
+/*
+  Sixteen cells at a time.  The neighbor count is the sum of eight
+  unaligned loads compared against 1, the birth and survival sets become a
+  few compares against the count, and dying cells just add one and wrap
+  to 0 after the last state.
+*/
+__attribute__((target("sse2")))
+static void sse2GenRow(const unsigned char *up, const unsigned char *cur,
+                       const unsigned char *down, unsigned char *out,
+                       int begin, int end, const GenKernelRule &rule) {
+    const __m128i one = _mm_set1_epi8(1);
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i last = _mm_set1_epi8(char(rule.states));
+
+    int j = begin;
+    for (; j+16 <= end; j += 16) {
+        __m128i count = _mm_add_epi8(liveBytes(up+j-1, one), liveBytes(up+j, one));
+        count = _mm_add_epi8(count, liveBytes(up+j+1, one));
+        count = _mm_add_epi8(count, liveBytes(cur+j-1, one));
+        count = _mm_add_epi8(count, liveBytes(cur+j+1, one));
+        count = _mm_add_epi8(count, liveBytes(down+j-1, one));
+        count = _mm_add_epi8(count, liveBytes(down+j, one));
+        count = _mm_add_epi8(count, liveBytes(down+j+1, one));
+
+        __m128i state = _mm_loadu_si128((const __m128i *)(cur+j));
+        __m128i dead = _mm_cmpeq_epi8(state, zero);
+        __m128i alive = _mm_cmpeq_epi8(state, one);
+
+        __m128i born = _mm_and_si128(dead, countIn(count, rule.birth));
+        __m128i stays = _mm_and_si128(alive, countIn(count, rule.survive));
+        __m128i becomesOne = _mm_or_si128(born, stays);
+
+        // Live cells that don't survive and dying cells move up a state
+        __m128i older = _mm_add_epi8(state, one);
+        older = _mm_andnot_si128(_mm_cmpeq_epi8(older, last), older);
+        older = _mm_andnot_si128(_mm_or_si128(dead, stays), older);
+
+        __m128i result = _mm_or_si128(_mm_and_si128(becomesOne, one), older);
+        _mm_storeu_si128((__m128i *)(out+j), result);
+    }
+    scalarGenRow(up, cur, down, out, j, end, rule);
+}
+
+#endif
+
+struct GenRowKernelInfo {
+    const char *name;
+    GenRowKernel kernel;
+};
+
+static GenRowKernelInfo detectGenRowKernel() {
+    GenRowKernelInfo info = { "Scalar", scalarGenRow };
+#ifdef GEN_X86_KERNELS
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("sse2")) {
+        info.name = "SSE2";
+        info.kernel = sse2GenRow;
+    }
+#endif
+    return info;
+}
+
+static const GenRowKernelInfo &bestGenRowKernel() {
+    static const GenRowKernelInfo info = detectGenRowKernel();
+    return info;
+}
+
+GenBoard::GenBoard() : w(0), h(0) {
+    setRule(genRule);
+}
+
+void GenBoard::resize(int width, int height) {
+    w = width;
+    h = height;
+    cells.assign(w*h, 0);
+    next.assign(w*h, 0);
+}
+
+void GenBoard::clear() {
+    std::fill(cells.begin(), cells.end(), 0);
+}
+
+void GenBoard::setRule(const GenRule &rule) {
+    genRule = rule;
+
+    for (int n=0; n<=8; ++n) {
+        bornTable[n] = (rule.life.birth >> n) & 1;
+        // A live cell that dies starts dying, or is dead in two state rules
+        survivorTable[n] = ((rule.life.survive >> n) & 1) ? 1 : (rule.states > 2 ? 2 : 0);
+    }
+    decayTable.assign(256, 0);
+    for (int s=2; s<rule.states; ++s) {
+        decayTable[s] = (s+1 < rule.states) ? s+1 : 0;
+    }
+
+    // Cells in states the new rule doesn't have are dead
+    for (size_t i=0; i<cells.size(); ++i) {
+        if (cells[i] >= rule.states) {
+            cells[i] = 0;
+        }
+    }
+}
+
+const char *GenBoard::kernelName() const {
+    return bestGenRowKernel().name;
+}
+
+void GenBoard::evolve() {
+    if (cells.empty()) return;
+
+    parallelBands(h, this, &GenBoard::evolveRows, 16384/qMax(w, 1) + 1);
+
+    cells.swap(next);
+}
+
+void GenBoard::evolveRows(int begin, int end) {
+    GenKernelRule rule;
+    rule.birth = genRule.life.birth;
+    rule.survive = genRule.life.survive;
+    rule.states = (unsigned char)genRule.states;
+    rule.born = bornTable;
+    rule.survivor = survivorTable;
+    rule.decay = &decayTable[0];
+
+    GenRowKernel kernel = bestGenRowKernel().kernel;
+
+    for (int i=begin; i<end; ++i) {
+        const unsigned char *up = &cells[((i + h - 1) % h)*w];
+        const unsigned char *cur = &cells[i*w];
+        const unsigned char *down = &cells[((i + 1) % h)*w];
+        unsigned char *out = &next[i*w];
+
+        if (w < 3) {
+            // Too narrow for the kernel, wrap every cell
+            for (int j=0; j<w; ++j) {
+                int west = (j + w - 1) % w;
+                int east = (j + 1) % w;
+                out[j] = nextState(cur[j], liveCount(up, cur, down, west, east, j), rule);
+            }
+            continue;
+        }
+
+        kernel(up, cur, down, out, 1, w-1, rule);
+        out[0] = nextState(cur[0], liveCount(up, cur, down, w-1, 1, 0), rule);
+        out[w-1] = nextState(cur[w-1], liveCount(up, cur, down, w-2, 0, w-1), rule);
+    }
+}
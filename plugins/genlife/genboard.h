@@ -0,0 +1,88 @@
+/*
+  genboard.h
+
+  Copyright (c) 2011, Jeremiah LaRocco jeremiah.larocco@gmail.com
+
+  Permission to use, copy, modify, and/or distribute this software for any
+  purpose with or without fee is hereby granted, provided that the above
+  copyright notice and this permission notice appear in all copies.
+
+  THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+  WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+  MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+  ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+  WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+  ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+  OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+
+#ifndef GEN_BOARD_INCLUDE_H
+#define GEN_BOARD_INCLUDE_H
+
+#include <string>
+#include <vector>
+#include <stdint.h>
+
+#include "liferule.h"
+
+/*
+  A Generations rule: a LifeRule for the live cells plus a number of
+  states.  State 0 is dead and 1 is alive; a live cell that doesn't
+  survive goes through states 2 .. states-1 before it is dead again, and
+  only state 1 counts as a neighbor.  Written like "B2/S/C3" (Brian's
+  Brain) or in the older survival/birth/states form "345/2/4".
+*/
+struct GenRule {
+    static const int MAX_STATES = 255;
+
+    LifeRule life;
+    int states;
+
+    GenRule() : life(1 << 2, 0), states(3) {}
+
+    // Leaves the rule alone and returns false if text isn't a valid rule
+    bool parse(const char *text);
+    std::string toString() const;
+};
+
+/*
+  A torus of byte-per-cell states.
+*/
+class GenBoard {
+public:
+    GenBoard();
+
+    void resize(int width, int height);
+    void clear();
+
+    int width() const { return w; }
+    int height() const { return h; }
+
+    unsigned char get(int row, int col) const { return cells[row*w + col]; }
+    void set(int row, int col, unsigned char state) { cells[row*w + col] = state; }
+
+    void setRule(const GenRule &rule);
+    const GenRule &rule() const { return genRule; }
+
+    void evolve();
+
+    // Name of the row kernel in use
+    const char *kernelName() const;
+
+private:
+    void evolveRows(int begin, int end);
+
+    int w, h;
+    GenRule genRule;
+
+    // Next state of a dead, live and dying cell by neighbor count and
+    // state, for the scalar edges
+    unsigned char bornTable[9];
+    unsigned char survivorTable[9];
+    std::vector<unsigned char> decayTable;
+
+    std::vector<unsigned char> cells;
+    std::vector<unsigned char> next;
+};
+
+#endif
@@ -0,0 +1,228 @@
+/*
+  genlife.cpp
+
+  Copyright (c) 2011, Jeremiah LaRocco jeremiah.larocco@gmail.com
+
+  Permission to use, copy, modify, and/or distribute this software for any
+  purpose with or without fee is hereby granted, provided that the above
+  copyright notice and this permission notice appear in all copies.
+
+  THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+  WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+  MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+  ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+  WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+  ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+  OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+
+#include <QtGui>
+#include <QDebug>
+
+#include <QSettings>
+
+#include <cstdlib>
+#include <vector>
+
+#include "genlife.h"
+
+#include "lifeparallel.h"
+
+#include "genlifeconfig.h"
+
+GenLife::GenLife() : width(256), height(256), prob(0.3), r(0),g(1),b(1),
+                     seed(0), boardSeed(0), fillBits(0), settings(0) {
+}
+
+void GenLife::readSettings(QSettings *sets) {
+    settings = sets;
+
+    width = sets->value("gen_width", 256).toInt();
+    height = sets->value("gen_height", 256).toInt();
+
+    prob = sets->value("gen_initial_fill", 0.3).toFloat();
+
+    r = sets->value("gen_red", 1.0).toFloat();
+    g = sets->value("gen_green", 1.0).toFloat();
+    b = sets->value("gen_blue", 0.2).toFloat();
+
+    GenRule newRule;
+    if (newRule.parse(sets->value("gen_rule", QString::fromLatin1(GenRule().toString().c_str())).toString().toLatin1().constData())) {
+        setRule(newRule);
+    }
+
+    seed = sets->value("gen_seed", 0).toULongLong();
+
+    reset();
+}
+
+void GenLife::configure(QWidget *parent, QSettings *sets) {
+    GenLifeConfig *cfgDlg = new GenLifeConfig(this, sets, parent);
+    cfgDlg->show();
+}
+
+GenLife::~GenLife() {
+    board.resize(0, 0);
+}
+
+QString GenLife::name() {
+    return tr("Generations");
+}
+
+QString GenLife::description() {
+    return tr("Life-like rules where dying cells fade through refractory states, like Brian's Brain and Star Wars.");
+}
+
+QString GenLife::engineInfo() {
+    return tr("Generations, %1, %2 kernel, seed %3")
+        .arg(QString::fromLatin1(board.rule().toString().c_str()))
+        .arg(QString::fromLatin1(board.kernelName()))
+        .arg(boardSeed);
+}
+
+// Only cells in state 1 are alive, the dying ones aren't counted
+double GenLife::population() {
+    double total = 0;
+    for (int i=0; i<board.height(); ++i) {
+        for (int j=0; j<board.width(); ++j) {
+            total += board.get(i, j) == 1;
+        }
+    }
+    return total;
+}
+
+bool GenLife::allowViewManipulation() {
+    return false;
+}
+
+void GenLife::initView() {
+    glClearColor(0,0,0,0);
+    glShadeModel(GL_SMOOTH);
+    glDisable(GL_LIGHTING);
+
+    glDisable(GL_LIGHT0);
+}
+
+void GenLife::resizeView(int width, int height) {
+    glViewport(0,0, (GLsizei) width, (GLsizei)height);
+    glMatrixMode(GL_PROJECTION);
+    glLoadIdentity();
+    gluOrtho2D(0, 100,
+               0, 100);
+
+    glMatrixMode(GL_MODELVIEW);
+
+    glClear(GL_COLOR_BUFFER_BIT);
+}
+
+bool GenLife::evolve() {
+    board.evolve();
+    return false;
+}
+
+void GenLife::draw() {
+    glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+    glPolygonMode(GL_FRONT_AND_BACK, GL_FILL);
+    float dx = 100.0/width;
+    float dy = 100.0/height;
+
+    // Live cells get the full color and dying cells fade out toward black
+    int states = board.rule().states;
+    std::vector<float> ramp(3*states, 0.0f);
+    for (int s=1; s<states; ++s) {
+        float fade = float(states - s)/float(states - 1);
+        ramp[3*s] = r*fade;
+        ramp[3*s+1] = g*fade;
+        ramp[3*s+2] = b*fade;
+    }
+
+    glBegin(GL_QUADS);
+    for (int i=0; i < height; ++i) {
+        float cy = i*dy;
+        for (int j=0; j<width; ++j) {
+            int state = board.get(i,j);
+            if (state) {
+                float cx = j*dx;
+                glColor3fv(&ramp[3*state]);
+                glVertex2f(cx, cy);
+                glVertex2f(cx+dx, cy);
+                glVertex2f(cx+dx, cy+dy);
+                glVertex2f(cx, cy+dy);
+            }
+        }
+    }
+    glEnd();
+    glFlush();
+}
+
+void GenLife::reset() {
+    board.resize(width, height);
+
+    boardSeed = seed ? seed : lifeNewSeed();
+    if (settings) {
+        settings->setValue("gen_last_seed", boardSeed);
+    }
+    LifeBernoulli bits(boardSeed, prob);
+    fillBits = &bits;
+    parallelBands(height, this, &GenLife::fillRows, 16384/qMax(width, 1) + 1);
+    fillBits = 0;
+}
+
+void GenLife::fillRows(int begin, int end) {
+    int words = (width+63)/64;
+    for (int i=begin; i<end; ++i) {
+        for (int k=0; k<words; ++k) {
+            uint64_t word = fillBits->word(uint64_t(i)*words + k);
+            int bits = qMin(64, width - 64*k);
+            for (int n=0; n<bits; ++n) {
+                board.set(i, 64*k + n, (word >> n) & 1);
+            }
+        }
+    }
+}
+
+void GenLife::setRGB(double red, double green, double blue) {
+    r = red;
+    g = green;
+    b = blue;
+}
+
+void GenLife::getRGB(double &red, double &green, double &blue) {
+    red = r;
+    green = g;
+    blue = b;
+}
+
+void GenLife::setProb(double probability) {
+    prob = probability;
+}
+
+void GenLife::getProb(double &probability) {
+    probability = prob;
+}
+
+void GenLife::setDim(int w, int h) {
+    width = w;
+    height = h;
+}
+void GenLife::getDim(int &w, int &h) {
+    w = width;
+    h = height;
+}
+
+void GenLife::setRule(const GenRule &newRule) {
+    board.setRule(newRule);
+}
+void GenLife::getRule(GenRule &curRule) {
+    curRule = board.rule();
+}
+
+void GenLife::setSeed(quint64 newSeed) {
+    seed = newSeed;
+}
+void GenLife::getSeed(quint64 &curSeed) {
+    curSeed = seed;
+}
+
+
+Q_EXPORT_PLUGIN2(genlife, GenLife)
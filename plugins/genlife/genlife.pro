@@ -0,0 +1,11 @@
+TEMPLATE      = lib
+CONFIG       += plugin
+
+QT += opengl
+
+HEADERS       = genlife.h genlifeconfig.h genboard.h
+SOURCES       = genlife.cpp genlifeconfig.cpp genboard.cpp
+
+DESTDIR       = ../../bin/plugins
+
+INCLUDEPATH   += ../../src
@@ -25,13 +25,14 @@
 
 #include "growlife.h"
 
-#include "growlifeconfig.h"
+#include "lifebits.h"
+#include "lifeparallel.h"
 
-size_t randUInt(size_t min, size_t max) {
-    return ((std::rand()%(max-min)) + min);
-}
+#include "growlifeconfig.h"
 
-GrowLife::GrowLife() : width(32), height(32), depth(32), prob(0.4), r(0),g(1),b(1) {
+GrowLife::GrowLife() : width(32), height(32), depth(32), prob(0.4), r(0),g(1),b(1),
+                       seed(0), boardSeed(0), fillBits(0), settings(0),
+                       meshList(0), listGeneration(0), listStale(true) {
     zoomAmount=100;
     rotateX = -40.0;
     rotateY = 0.0;
@@ -40,6 +41,8 @@ GrowLife::GrowLife() : width(32), height(32), depth(32), prob(0.4), r(0),g(1),b(
 }
 
 void GrowLife::readSettings(QSettings *sets) {
+    settings = sets;
+
     width = sets->value("grow_width", 80).toInt();
     height = sets->value("grow_height", 80).toInt();
     depth = sets->value("grow_depth", 120).toInt();
@@ -50,6 +53,13 @@ void GrowLife::readSettings(QSettings *sets) {
     g = sets->value("grow_green", 0.8).toFloat();
     b = sets->value("grow_blue", 0.4).toFloat();
 
+    LifeRule newRule;
+    if (newRule.parse(sets->value("grow_rule", "B3/S23").toString().toLatin1().constData())) {
+        rule = newRule;
+    }
+    seed = sets->value("grow_seed", 0).toULongLong();
+    mesh.setMerge(sets->value("grow_merge_faces", false).toBool());
+
     reset();
 }
 
@@ -59,7 +69,6 @@ void GrowLife::configure(QWidget *parent, QSettings *sets) {
 }
 
 GrowLife::~GrowLife() {
-    array.clear();
 }
 
 QString GrowLife::name() {
@@ -70,6 +79,17 @@ QString GrowLife::description() {
     return tr("Traditional Conway's game of life.");
 }
 
+QString GrowLife::engineInfo() {
+    return tr("Grow Life, %1, seed %2")
+        .arg(QString::fromLatin1(rule.toString().c_str()))
+        .arg(boardSeed);
+}
+
+// Live cells in the newest layer
+double GrowLife::population() {
+    return double(cells.slabPopulation(curLevel));
+}
+
 bool GrowLife::allowViewManipulation() {
     return true;
 }
@@ -95,10 +115,6 @@ void GrowLife::initLights() {
         lmodel_ambient[i][2]=0.4;
         lmodel_ambient[i][3]=1.0;
     }
-
-    glEnable(GL_LIGHTING);
-    glEnable(GL_LIGHT0);
-    glEnable(GL_LIGHT1);
 }
 void GrowLife::initMaterials() {
     // lines
@@ -155,6 +171,22 @@ void GrowLife::initView() {
 
     initLights();
     initMaterials();
+
+    glEnable(GL_LIGHTING);
+    glEnable(GL_LIGHT0);
+    glEnable(GL_LIGHT1);
+
+    // The context may be new, and any list from an old one went with it
+    meshList = 0;
+    listStale = true;
+}
+
+void GrowLife::releaseView() {
+    if (meshList) {
+        glDeleteLists(meshList, 1);
+        meshList = 0;
+    }
+    listStale = true;
 }
 
 void GrowLife::resizeView(int width, int height) {
@@ -169,35 +201,60 @@ void GrowLife::resizeView(int width, int height) {
 }
 
 bool GrowLife::evolve() {
-    if (curLevel>=depth) return true;
+    // The next level has to fit in the volume
+    if (curLevel+1>=depth) return true;
 
+    // Each level is evolved from the one below it, 64 cells per word
+    parallelBands(height, this, &GrowLife::evolveRows, 16384/qMax(width, 1) + 1);
+
+    curLevel += 1;
+    return false;
+}
+
+// Picks the evolve loop compiled for the current rule
+void GrowLife::evolveRows(int begin, int end) {
+    switch (rule.kind()) {
+    case LifeRule::Conway:
+        evolveRuleRows<ConwayRule>(begin, end);
+        break;
+    case LifeRule::HighLife:
+        evolveRuleRows<HighLifeRule>(begin, end);
+        break;
+    case LifeRule::DayAndNight:
+        evolveRuleRows<DayAndNightRule>(begin, end);
+        break;
+    case LifeRule::Seeds:
+        evolveRuleRows<SeedsRule>(begin, end);
+        break;
+    default:
+        evolveRuleRows<MaskRule>(begin, end);
+        break;
+    }
+}
+
+template <class Rule>
+void GrowLife::evolveRuleRows(int begin, int end) {
+    Rule r(rule);
     int h = height;
-    int w = width;
-    int d = depth;
+    int words = cells.words();
+    uint64_t last = cells.lastMask();
 
     int nextLevel = curLevel + 1;
-    
-    for (int i=0; i<h; ++i) {
-        for (int j=0; j<w; ++j) {
-            int num = countNeighbors(i,j, curLevel);
-            
-            if (array[i][j][curLevel]) {
-                if ((num < 2) || (num > 3)) {
-                    array[i][j][nextLevel] = false;
-                } else {
-                    array[i][j][nextLevel] = true;
-                }
-            } else {
-                if (num == 3) {
-                    array[i][j][nextLevel] = true;
-                } else {
-                    array[i][j][nextLevel] = false;
-                }
-            }
+
+    for (int i=begin; i<end; ++i) {
+        const uint64_t *up = cells.row(i > 0 ? i-1 : h-1, curLevel);
+        const uint64_t *cur = cells.row(i, curLevel);
+        const uint64_t *down = cells.row(i < h-1 ? i+1 : 0, curLevel);
+        uint64_t *out = cells.row(i, nextLevel);
+
+        for (int k=0; k<words; ++k) {
+            out[k] = ruleWord(r,
+                              cells.westWord(up, k), up[k], cells.eastWord(up, k),
+                              cells.westWord(cur, k), cur[k], cells.eastWord(cur, k),
+                              cells.westWord(down, k), down[k], cells.eastWord(down, k));
         }
+        out[words-1] &= last;
     }
-    curLevel += 1;
-    return false;
 }
 
 void GrowLife::draw() {
@@ -231,23 +288,6 @@ void GrowLife::draw() {
     glLoadIdentity();
 
 
-    static GLfloat cubeCorners[] = {0.02f, 0.98f, 0.98f,
-                                     0.98f, 0.98f, 0.98f,
-                                    0.98f, 0.02f, 0.98f,
-                                    0.02f, 0.02f, 0.98f,
-                                    0.02f, 0.98f, 0.02f,
-                                    0.98f, 0.98f, 0.02f,
-                                    0.98f, 0.02f, 0.02f,
-                                    0.02f, 0.02f, 0.02f,
-    };
-    static GLubyte indexes[] = {0, 1, 2, 3,
-                                4, 5, 1, 0,
-                                3, 2, 6, 7,
-                                5, 4, 7, 6,
-                                1, 5, 6, 2,
-                                4, 0, 3, 7,
-    };
-
     glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
     glEnable(GL_BLEND);
     glEnable(GL_POINT_SMOOTH);
@@ -257,58 +297,17 @@ void GrowLife::draw() {
     glEnable(GL_POLYGON_SMOOTH);
     glHint(GL_POLYGON_SMOOTH_HINT, GL_NICEST);
 
-    // glTranslatef(-0.5*width, -0.5*height, 0);
-    float dx = 100.0/width;
-    float dy = 100.0/height;
-    float dz = 100.0/depth;
-    glEnableClientState(GL_VERTEX_ARRAY);
-                    
     glTranslatef(-0.5*width, -0.5*height, -0.5*depth);
 
-    // qDebug() << "Drawing";
-    for (int i=0; i < height; ++i) {
-        float cy = i*dy;
-        for (int j=0; j<width; ++j) {
-            float cx = j*dx;
-            
-            for (int k=0;k<curLevel; ++k) {
-                float cz = k*dz;
-
-                if (array[i][j][k]) {
-                    
-                    // Draw the box
-                    glPushMatrix();
-                    // glScalef(0.25, 0.25, 0.25);
-                    glTranslatef(i,
-                                 j,
-                                 k);
-                    glMaterialfv(GL_FRONT_AND_BACK, GL_DIFFUSE, mat_diffuse[BOX_MAT]);
-                    glMaterialfv(GL_FRONT_AND_BACK, GL_AMBIENT, mat_ambient[BOX_MAT]);
-                    glMaterialfv(GL_FRONT_AND_BACK, GL_SPECULAR, mat_specular[BOX_MAT]);
-                    glMaterialfv(GL_FRONT_AND_BACK, GL_SHININESS, mat_shininess[BOX_MAT]);
-                    glPolygonMode(GL_FRONT_AND_BACK, GL_FILL);
-
-                    glVertexPointer(3, GL_FLOAT, 0, cubeCorners);
-
-                    glDrawElements(GL_QUADS, 24, GL_UNSIGNED_BYTE, indexes);
-    
-                    glLineWidth(1.5);
-
-                    glMaterialfv(GL_FRONT_AND_BACK, GL_DIFFUSE, mat_diffuse[LINE_MAT]);
-                    glMaterialfv(GL_FRONT_AND_BACK, GL_AMBIENT, mat_ambient[LINE_MAT]);
-                    glMaterialfv(GL_FRONT_AND_BACK, GL_SPECULAR, mat_specular[LINE_MAT]);
-                    glMaterialfv(GL_FRONT_AND_BACK, GL_SHININESS, mat_shininess[LINE_MAT]);
-
-                    glPolygonMode(GL_FRONT_AND_BACK, GL_LINE);// Draw the outline
-                    glVertexPointer(3, GL_FLOAT, 0, cubeCorners);
-                    glDrawElements(GL_QUADS, 24, GL_UNSIGNED_BYTE, indexes);
-    
-                    glLineWidth(1.0);
-                    glPopMatrix();
-                }
-            }
-        }
+    // Moving the camera only calls the list again, the geometry is only
+    // meshed and compiled once per generation
+    if (listStale || listGeneration != curLevel) {
+        mesh.update(cells, curLevel);
+        compileMeshList();
+        listGeneration = curLevel;
+        listStale = false;
     }
+    glCallList(meshList);
 
     // Reset to how we found things
     glPopMatrix();
@@ -320,44 +319,57 @@ void GrowLife::draw() {
     glFlush();
 }
 
+void GrowLife::compileMeshList() {
+    if (!meshList) {
+        meshList = glGenLists(1);
+    }
+    glNewList(meshList, GL_COMPILE);
+    // Every face, then every outline, with the materials set once for each
+    glMaterialfv(GL_FRONT_AND_BACK, GL_DIFFUSE, mat_diffuse[BOX_MAT]);
+    glMaterialfv(GL_FRONT_AND_BACK, GL_AMBIENT, mat_ambient[BOX_MAT]);
+    glMaterialfv(GL_FRONT_AND_BACK, GL_SPECULAR, mat_specular[BOX_MAT]);
+    glMaterialfv(GL_FRONT_AND_BACK, GL_SHININESS, mat_shininess[BOX_MAT]);
+    glPolygonMode(GL_FRONT_AND_BACK, GL_FILL);
+    mesh.draw();
+
+    glLineWidth(1.5);
+    glMaterialfv(GL_FRONT_AND_BACK, GL_DIFFUSE, mat_diffuse[LINE_MAT]);
+    glMaterialfv(GL_FRONT_AND_BACK, GL_AMBIENT, mat_ambient[LINE_MAT]);
+    glMaterialfv(GL_FRONT_AND_BACK, GL_SPECULAR, mat_specular[LINE_MAT]);
+    glMaterialfv(GL_FRONT_AND_BACK, GL_SHININESS, mat_shininess[LINE_MAT]);
+    glPolygonMode(GL_FRONT_AND_BACK, GL_LINE);
+    mesh.draw();
+    glLineWidth(1.0);
+    glPolygonMode(GL_FRONT_AND_BACK, GL_FILL);
+    glEndList();
+}
+
 void GrowLife::reset() {
-    array.clear();
     curLevel = 0;
-    array.resize(height);
-    for (int i=0; i<height; ++i) {
-        array[i].resize(width);
-        for (int j=0;j<width; ++j) {
-            array[i][j].resize(depth, false);
-        }
-    }
-    int num = prob*width*height;
-    for (int i=0;i<num; ++i) {
-        size_t ri = randUInt(0, height);
-        size_t rj = randUInt(0, width);
-        array[ri][rj][0] = true;
+    cells.resize(width, height, depth);
+    listStale = true;
+
+    boardSeed = seed ? seed : lifeNewSeed();
+    if (settings) {
+        settings->setValue("grow_last_seed", boardSeed);
     }
+    LifeBernoulli bits(boardSeed, prob);
+    fillBits = &bits;
+    parallelBands(height, this, &GrowLife::fillRows, 16384/qMax(width, 1) + 1);
+    fillBits = 0;
     initMaterials();
 }
-int GrowLife::countNeighbors(int i, int j, int k) {
-    int w = width;
-    int h = height;
-
-    int num = 0;
-    int up = i-1>0 ? i-1 : h-1;
-    int down = i+1 <h-1 ? i+1 : 0;
-    int left = j-1>0 ? j-1 : w-1;
-    int right = j+1 < w-1 ? j+1 : 0;
-    
-    num += array[up][j][k];
-    num += array[down][j][k];
-    num += array[i][left][k];
-    num += array[i][right][k];
-    num += array[up][left][k];
-    num += array[up][right][k];
-    num += array[down][left][k];
-    num += array[down][right][k];
 
-    return num;
+// Only the first layer is seeded, the rest grow from it
+void GrowLife::fillRows(int begin, int end) {
+    int words = cells.words();
+    for (int i=begin; i<end; ++i) {
+        uint64_t *row = cells.row(i, 0);
+        for (int k=0; k<words; ++k) {
+            row[k] = fillBits->word(uint64_t(i)*words + k);
+        }
+        row[words-1] &= cells.lastMask();
+    }
 }
 
 void GrowLife::setRGB(double red, double green, double blue) {
@@ -381,6 +393,28 @@ void GrowLife::getProb(double &probability) {
     probability = prob;
 }
 
+void GrowLife::setRule(const LifeRule &newRule) {
+    rule = newRule;
+}
+void GrowLife::getRule(LifeRule &curRule) {
+    curRule = rule;
+}
+
+void GrowLife::setSeed(quint64 newSeed) {
+    seed = newSeed;
+}
+void GrowLife::getSeed(quint64 &curSeed) {
+    curSeed = seed;
+}
+
+void GrowLife::setMergeFaces(bool merge) {
+    mesh.setMerge(merge);
+    listStale = true;
+}
+void GrowLife::getMergeFaces(bool &merge) {
+    merge = mesh.merging();
+}
+
 void GrowLife::setDim(int w, int h, int d) {
     width = w;
     height = h;
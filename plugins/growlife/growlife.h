@@ -31,6 +31,10 @@
 #endif
 
 #include "lifeplugin.h"
+#include "liferule.h"
+#include "liferandom.h"
+#include "lifevolume.h"
+#include "lifemesh.h"
 
 static const size_t NUM_MATERIALS=2;
 static const size_t NUM_LIGHTS=2;
@@ -38,10 +42,6 @@ static const size_t NUM_LIGHTS=2;
 static const size_t LINE_MAT=0;
 static const size_t BOX_MAT=1;
 
-typedef std::vector<bool>       vector_1d;
-typedef std::vector<vector_1d> vector_2d;
-typedef std::vector<vector_2d> vector_3d;
-
 
 class GrowLife : public QObject, public LifePlugin {
     Q_OBJECT;
@@ -56,6 +56,7 @@ public:
 
     virtual bool allowViewManipulation();
     virtual void initView();
+    virtual void releaseView();
     virtual void resizeView(int width, int height);
     virtual bool evolve();
     virtual void draw();
@@ -64,6 +65,9 @@ public:
     virtual void readSettings(QSettings *sets);
     virtual void configure(QWidget *parent, QSettings *sets);
 
+    virtual QString engineInfo();
+    virtual double population();
+
     virtual void zoom(double amt);
     virtual void rotate(double x, double y, double z);
 
@@ -73,21 +77,46 @@ public:
     void setProb(double probability);
     void getProb(double &prob);
 
+    void setRule(const LifeRule &newRule);
+    void getRule(LifeRule &curRule);
+
+    // Boards are filled from this seed, or a new one each reset() if 0
+    void setSeed(quint64 newSeed);
+    void getSeed(quint64 &curSeed);
+
+    // Draw merged quads instead of one face per cell; the outlines then go
+    // around the quads, so the edges between cells no longer show
+    void setMergeFaces(bool merge);
+    void getMergeFaces(bool &merge);
+
     void setDim(int w, int h, int d);
     void getDim(int &w, int &h, int &d);
     
 private:
-    int countNeighbors(int i, int j, int k);
+    void evolveRows(int begin, int end);
+    template <class Rule>
+    void evolveRuleRows(int begin, int end);
+
+    void fillRows(int begin, int end);
 
 private:
-    vector_3d array;
+    // Cell (i, j, k) is at x = j, y = i, z = k, so each level is a slab
+    LifeVolume cells;
 
     int width, height, depth;
     double prob;
+    LifeRule rule;
     double r,g,b;
 
+    quint64 seed;
+    // Seed of the current board, saved as grow_last_seed
+    quint64 boardSeed;
+    const LifeBernoulli *fillBits;
+    QSettings *settings;
+
     void initLights();
     void initMaterials();
+    void compileMeshList();
 
     // Arrays to hold light properties
     GLfloat light_position[NUM_LIGHTS][4];
@@ -103,6 +132,13 @@ private:
     double rotateX, rotateY, rotateZ;
     double zoomAmount;
 
+    // Faces of the live cells, and a display list that draws them with
+    // their materials, compiled for generation listGeneration
+    LifeMesh mesh;
+    GLuint meshList;
+    uint64_t listGeneration;
+    bool listStale;
+
     size_t curLevel;
 };
 
@@ -71,9 +71,39 @@ GrowLifeConfig::GrowLifeConfig(GrowLife *sl,
     blueEdit = new QLineEdit(tr("%1").arg(b,0,'g', 3));
     layout->addWidget(blueEdit, curRow, 1);
     curRow += 1;
+    LifeRule rule;
+    life->getRule(rule);
+    layout->addWidget(new QLabel(tr("Rule")), curRow, 0);
+    ruleCombo = new QComboBox;
+    ruleCombo->setEditable(true);
+    ruleCombo->addItem("B3/S23");
+    ruleCombo->addItem("B36/S23");
+    ruleCombo->addItem("B3678/S34678");
+    ruleCombo->addItem("B2/S");
+    ruleCombo->setEditText(QString::fromLatin1(rule.toString().c_str()));
+    layout->addWidget(ruleCombo, curRow, 1);
+    curRow += 1;
+
     // QPushButton *colorPicker = new QPushButton("");
     // colorPicker->
         
+    quint64 seed;
+    life->getSeed(seed);
+    layout->addWidget(new QLabel(tr("Seed (0 for a new one each reset)")), curRow, 0);
+    seedEdit = new QLineEdit(tr("%1").arg(seed));
+    layout->addWidget(seedEdit, curRow, 1);
+    curRow += 1;
+
+    bool merge;
+    life->getMergeFaces(merge);
+    layout->addWidget(new QLabel(tr("Faces")), curRow, 0);
+    facesCombo = new QComboBox;
+    facesCombo->addItem(tr("One per cell"), false);
+    facesCombo->addItem(tr("Merged, outlines without cell edges"), true);
+    facesCombo->setCurrentIndex(facesCombo->findData(merge));
+    layout->addWidget(facesCombo, curRow, 1);
+    curRow += 1;
+
     okayButton = new QPushButton(tr("Okay"));
     layout->addWidget(okayButton, curRow, 0);
     connect(okayButton, SIGNAL(clicked()), this, SLOT(finish()));
@@ -90,21 +120,38 @@ void GrowLifeConfig::finish() {
     int newWidth = widthEdit->text().toInt();
     int newHeight = heightEdit->text().toInt();
     int newDepth = depthEdit->text().toInt();
+    if (newWidth < 1 || newHeight < 1 || newDepth < 1) {
+        QMessageBox::warning(this, tr("Grow Life"),
+                             tr("The board has to be at least 1x1x1."));
+        return;
+    }
 
     double newProb = probEdit->text().toDouble();
     double newRed = redEdit->text().toDouble();
     double newGreen = greenEdit->text().toDouble();
     double newBlue = blueEdit->text().toDouble();
+    quint64 newSeed = seedEdit->text().toULongLong();
+    bool newMerge = facesCombo->itemData(facesCombo->currentIndex()).toBool();
+
+    LifeRule newRule;
+    if (!newRule.parse(ruleCombo->currentText().toLatin1().constData())) {
+        QMessageBox::warning(this, tr("Grow Life"),
+                             tr("\"%1\" is not a rule like B3/S23.").arg(ruleCombo->currentText()));
+        return;
+    }
 
     if (settings) {
         settings->setValue("grow_width", newWidth);
         settings->setValue("grow_height", newHeight);
         settings->setValue("grow_depth", newDepth);
         settings->setValue("grow_initial_fill", newProb);
+        settings->setValue("grow_rule", QString::fromLatin1(newRule.toString().c_str()));
 
         settings->value("grow_red", newRed);
         settings->value("grow_green", newGreen);
         settings->value("grow_blue", newBlue);
+        settings->setValue("grow_seed", newSeed);
+        settings->setValue("grow_merge_faces", newMerge);
 
         settings->sync();
     }
@@ -112,6 +159,9 @@ void GrowLifeConfig::finish() {
     life->setDim(newWidth, newHeight, newDepth);
     life->setProb(newProb);
     life->setRGB(newRed, newGreen, newBlue);
+    life->setRule(newRule);
+    life->setSeed(newSeed);
+    life->setMergeFaces(newMerge);
 
     this->close();
 
@@ -26,6 +26,7 @@
 class QPushButton;
 class QLineEdit;
 class QLabel;
+class QComboBox;
 class QSettings;
 
 class GrowLifeConfig : public QDialog {
@@ -47,6 +48,11 @@ private:
     QLineEdit *greenEdit;
     QLineEdit *blueEdit;
 
+    QLineEdit *seedEdit;
+    QComboBox *facesCombo;
+
+    QComboBox *ruleCombo;
+
     QPushButton *okayButton;
     QPushButton *cancelButton;
 
@@ -0,0 +1,351 @@
+/*
+  hashlife.cpp
+
+  Copyright (c) 2011, Jeremiah LaRocco jeremiah.larocco@gmail.com
+
+  Permission to use, copy, modify, and/or distribute this software for any
+  purpose with or without fee is hereby granted, provided that the above
+  copyright notice and this permission notice appear in all copies.
+
+  THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+  WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+  MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+  ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+  WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+  ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+  OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+
+#include <QtGui>
+#include <QDebug>
+
+#include <QSettings>
+
+#include <cstdlib>
+#include <cmath>
+
+#include "hashlife.h"
+
+#include "hashlifeconfig.h"
+
+HashLife::HashLife() : width(128), height(128), prob(0.4), r(0),g(1),b(1),
+                       stepLog(0), memoryBudget(256),
+                       viewWidth(1), viewHeight(1), viewLeft(0), viewTop(0),
+                       visibleWidth(1), visibleHeight(1), pixelSize(1),
+                       seed(0), boardSeed(0), settings(0) {
+}
+
+void HashLife::readSettings(QSettings *sets) {
+    settings = sets;
+
+    width = sets->value("hash_width", 128).toInt();
+    height = sets->value("hash_height", 128).toInt();
+
+    prob = sets->value("hash_initial_fill", 0.4).toFloat();
+
+    r = sets->value("hash_red", 0.0).toFloat();
+    g = sets->value("hash_green", 0.8).toFloat();
+    b = sets->value("hash_blue", 0.4).toFloat();
+
+    LifeRule newRule;
+    if (newRule.parse(sets->value("hash_rule", "B3/S23").toString().toLatin1().constData()) &&
+        !(newRule.birth & 1)) {
+        setRule(newRule);
+    }
+
+    stepLog = sets->value("hash_step_log", 0).toInt();
+    memoryBudget = sets->value("hash_memory_mb", 256).toInt();
+    patternFile = sets->value("hash_pattern_file", QString()).toString();
+
+    seed = sets->value("hash_seed", 0).toULongLong();
+
+    reset();
+}
+
+void HashLife::configure(QWidget *parent, QSettings *sets) {
+    HashLifeConfig *cfgDlg = new HashLifeConfig(this, sets, parent);
+    cfgDlg->show();
+}
+
+HashLife::~HashLife() {
+    tree.clear();
+}
+
+QString HashLife::name() {
+    return tr("HashLife");
+}
+
+QString HashLife::description() {
+    return tr("Conway's game of life on an unbounded plane, using Gosper's HashLife to skip ahead 2^k generations at a time.");
+}
+
+QString HashLife::engineInfo() {
+    return tr("HashLife, %1, seed %2, step 2^%3, generation %4, population %5, %6 nodes (%7 MB)")
+        .arg(QString::fromLatin1(tree.rule().toString().c_str()))
+        .arg(boardSeed)
+        .arg(tree.stepLog())
+        .arg(qulonglong(tree.generation()))
+        .arg(tree.population(), 0, 'g', 12)
+        .arg(qulonglong(tree.nodeCount()))
+        .arg(qulonglong(tree.memoryUsed() >> 20));
+}
+
+double HashLife::population() {
+    return tree.population();
+}
+
+qint64 HashLife::generationsPerStep() {
+    return qint64(1) << tree.stepLog();
+}
+
+bool HashLife::allowViewManipulation() {
+    return false;
+}
+
+void HashLife::initView() {
+    glClearColor(0,0,0,0);
+    glShadeModel(GL_SMOOTH);
+    glDisable(GL_LIGHTING);
+
+    glDisable(GL_LIGHT0);
+}
+
+void HashLife::resizeView(int width, int height) {
+    viewWidth = width > 0 ? width : 1;
+    viewHeight = height > 0 ? height : 1;
+
+    glViewport(0,0, (GLsizei) width, (GLsizei)height);
+    glMatrixMode(GL_MODELVIEW);
+
+    glClear(GL_COLOR_BUFFER_BIT);
+}
+
+bool HashLife::evolve() {
+    tree.step();
+    return false;
+}
+
+void HashLife::draw() {
+    glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+    glPolygonMode(GL_FRONT_AND_BACK, GL_FILL);
+
+    int64_t minX, minY, maxX, maxY;
+    if (!tree.bounds(minX, minY, maxX, maxY)) {
+        glFlush();
+        return;
+    }
+
+    // Fit the pattern in the window, with a small border, keeping cells square
+    double spanX = double(maxX - minX + 1);
+    double spanY = double(maxY - minY + 1);
+    pixelSize = 1.1*qMax(spanX/viewWidth, spanY/viewHeight);
+    visibleWidth = pixelSize*viewWidth;
+    visibleHeight = pixelSize*viewHeight;
+    viewLeft = 0.5*(double(minX) + double(maxX) + 1) - 0.5*visibleWidth;
+    viewTop = 0.5*(double(minY) + double(maxY) + 1) - 0.5*visibleHeight;
+
+    // Vertices are relative to the corner of the view so huge coordinates
+    // don't lose precision
+    glMatrixMode(GL_PROJECTION);
+    glLoadIdentity();
+    gluOrtho2D(0, visibleWidth, visibleHeight, 0);
+    glMatrixMode(GL_MODELVIEW);
+    glLoadIdentity();
+
+    HashNode *root = tree.rootNode();
+    double half = std::ldexp(1.0, root->level-1);
+
+    glColor3f(r,g,b);
+    glBegin(GL_QUADS);
+    drawNode(root, -half - viewLeft, -half - viewTop, 2*half);
+    glEnd();
+
+    glFlush();
+}
+
+/*
+  Draws the live cells of a node whose top left corner is at (x, y).  Nodes
+  smaller than a pixel are drawn as a single quad instead of walking down
+  to the cells, so drawing costs about one quad per lit pixel no matter
+  how large the pattern is.
+*/
+void HashLife::drawNode(const HashNode *node, double x, double y, double size) {
+    if (node->population == 0) {
+        return;
+    }
+    if (x > visibleWidth || y > visibleHeight || x+size < 0 || y+size < 0) {
+        return;
+    }
+    if (node->level == 0 || size <= pixelSize) {
+        glVertex2d(x, y);
+        glVertex2d(x+size, y);
+        glVertex2d(x+size, y+size);
+        glVertex2d(x, y+size);
+        return;
+    }
+    double half = 0.5*size;
+    drawNode(node->nw, x, y, half);
+    drawNode(node->ne, x+half, y, half);
+    drawNode(node->sw, x, y+half, half);
+    drawNode(node->se, x+half, y+half, half);
+}
+
+void HashLife::reset() {
+    tree.clear();
+    tree.setStepLog(stepLog);
+    tree.setMemoryBudget(size_t(memoryBudget) << 20);
+
+    if (!patternFile.isEmpty() && loadPattern()) {
+        return;
+    }
+
+    boardSeed = seed ? seed : lifeNewSeed();
+    if (settings) {
+        settings->setValue("hash_last_seed", boardSeed);
+    }
+
+    // Same words as SimpleLife's board, centered on the origin
+    LifeBernoulli bits(boardSeed, prob);
+    int words = (width+63)/64;
+    for (int i=0; i<height; ++i) {
+        for (int k=0; k<words; ++k) {
+            uint64_t word = bits.word(uint64_t(i)*words + k);
+            if (k == words-1 && (width & 63)) {
+                word &= (uint64_t(1) << (width & 63)) - 1;
+            }
+            while (word) {
+                int n = __builtin_ctzll(word);
+                word &= word - 1;
+                tree.setCell(int64_t(64*k + n) - width/2, int64_t(i) - height/2, true);
+            }
+        }
+    }
+    tree.collectGarbage();
+}
+
+/*
+  Reads an RLE pattern ("x = ..." header, b/o runs, $ for new lines and !
+  at the end), centered on the origin.
+*/
+bool HashLife::loadPattern() {
+    QFile file(patternFile);
+    if (!file.open(QIODevice::ReadOnly | QIODevice::Text)) {
+        qDebug() << "Couldn't open pattern" << patternFile;
+        return false;
+    }
+
+    int64_t patWidth = 0, patHeight = 0;
+    int64_t x = 0, y = 0;
+    int64_t count = 0;
+    bool done = false;
+
+    while (!file.atEnd() && !done) {
+        QByteArray line = file.readLine().trimmed();
+        if (line.isEmpty() || line[0] == '#') {
+            continue;
+        }
+        if (line[0] == 'x') {
+            QList<QByteArray> fields = line.split(',');
+            for (int i=0; i<fields.size(); ++i) {
+                QList<QByteArray> kv = fields[i].split('=');
+                if (kv.size() != 2) continue;
+                if (kv[0].trimmed() == "x") patWidth = kv[1].trimmed().toLongLong();
+                if (kv[0].trimmed() == "y") patHeight = kv[1].trimmed().toLongLong();
+            }
+            continue;
+        }
+        for (int i=0; i<line.size() && !done; ++i) {
+            char c = line[i];
+            if (c >= '0' && c <= '9') {
+                count = count*10 + (c-'0');
+                continue;
+            }
+            int64_t run = count ? count : 1;
+            count = 0;
+            if (c == 'b' || c == '.') {
+                x += run;
+            } else if (c == '$') {
+                x = 0;
+                y += run;
+            } else if (c == '!') {
+                done = true;
+            } else if (c == 'o' || (c >= 'A' && c <= 'Z')) {
+                for (int64_t k=0; k<run; ++k) {
+                    tree.setCell(x - patWidth/2, y - patHeight/2, true);
+                    ++x;
+                }
+            }
+        }
+    }
+    tree.collectGarbage();
+    return true;
+}
+
+void HashLife::setRGB(double red, double green, double blue) {
+    r = red;
+    g = green;
+    b = blue;
+}
+
+void HashLife::getRGB(double &red, double &green, double &blue) {
+    red = r;
+    green = g;
+    blue = b;
+}
+
+void HashLife::setProb(double probability) {
+    prob = probability;
+}
+
+void HashLife::getProb(double &probability) {
+    probability = prob;
+}
+
+void HashLife::setDim(int w, int h) {
+    width = w;
+    height = h;
+}
+void HashLife::getDim(int &w, int &h) {
+    w = width;
+    h = height;
+}
+
+void HashLife::setRule(const LifeRule &newRule) {
+    tree.setRule(newRule);
+}
+void HashLife::getRule(LifeRule &curRule) {
+    curRule = tree.rule();
+}
+
+void HashLife::setSeed(quint64 newSeed) {
+    seed = newSeed;
+}
+void HashLife::getSeed(quint64 &curSeed) {
+    curSeed = seed;
+}
+
+void HashLife::setStepLog(int log) {
+    stepLog = log;
+    tree.setStepLog(log);
+}
+void HashLife::getStepLog(int &log) {
+    log = stepLog;
+}
+
+void HashLife::setMemoryBudget(int megabytes) {
+    memoryBudget = megabytes;
+    tree.setMemoryBudget(size_t(megabytes) << 20);
+}
+void HashLife::getMemoryBudget(int &megabytes) {
+    megabytes = memoryBudget;
+}
+
+void HashLife::setPatternFile(const QString &fileName) {
+    patternFile = fileName;
+}
+void HashLife::getPatternFile(QString &fileName) {
+    fileName = patternFile;
+}
+
+
+Q_EXPORT_PLUGIN2(hashlife, HashLife)
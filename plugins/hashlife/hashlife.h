@@ -0,0 +1,114 @@
+/*
+  hashlife.h
+
+  Copyright (c) 2011, Jeremiah LaRocco jeremiah.larocco@gmail.com
+
+  Permission to use, copy, modify, and/or distribute this software for any
+  purpose with or without fee is hereby granted, provided that the above
+  copyright notice and this permission notice appear in all copies.
+
+  THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+  WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+  MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+  ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+  WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+  ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+  OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+
+#ifndef HASH_LIFE_INCLUDE_H
+#define HASH_LIFE_INCLUDE_H
+
+#include <QObject>
+#include <QWidget>
+
+#ifdef __APPLE_CC__
+#include <OpenGL/gl.h>
+#include <OpenGL/glu.h>
+#else
+#include <GL/gl.h>
+#include <GL/glu.h>
+#endif
+
+#include "lifeplugin.h"
+#include "liferandom.h"
+
+#include "hashtree.h"
+
+class HashLife : public QObject, public LifePlugin {
+    Q_OBJECT;
+    Q_INTERFACES(LifePlugin);
+
+public:
+    HashLife();
+    ~HashLife();
+
+    virtual QString name();
+    virtual QString description();
+
+    virtual bool allowViewManipulation();
+    virtual void initView();
+    virtual void resizeView(int width, int height);
+    virtual bool evolve();
+    virtual void draw();
+    virtual void reset();
+
+    virtual void readSettings(QSettings *sets);
+    virtual void configure(QWidget *parent, QSettings *sets);
+
+    virtual QString engineInfo();
+    virtual double population();
+    virtual qint64 generationsPerStep();
+
+    void setRGB(double red, double green, double blue);
+    void getRGB(double &red, double &green, double &blue);
+
+    void setProb(double probability);
+    void getProb(double &prob);
+
+    void setDim(int w, int h);
+    void getDim(int &w, int &h);
+
+    void setRule(const LifeRule &newRule);
+    void getRule(LifeRule &curRule);
+
+    // Boards are filled from this seed, or a new one each reset() if 0
+    void setSeed(quint64 newSeed);
+    void getSeed(quint64 &curSeed);
+
+    void setStepLog(int log);
+    void getStepLog(int &log);
+
+    void setMemoryBudget(int megabytes);
+    void getMemoryBudget(int &megabytes);
+
+    void setPatternFile(const QString &fileName);
+    void getPatternFile(QString &fileName);
+
+private:
+    bool loadPattern();
+    void drawNode(const HashNode *node, double x, double y, double size);
+
+private:
+    HashTree tree;
+
+    int width, height;
+    double prob;
+    double r,g,b;
+    int stepLog;
+    int memoryBudget;
+    QString patternFile;
+
+    // Widget size in pixels, and the part of the plane it currently shows
+    int viewWidth, viewHeight;
+    double viewLeft, viewTop;
+    double visibleWidth, visibleHeight;
+    double pixelSize;
+
+    quint64 seed;
+    // Seed of the current board, saved as hash_last_seed
+    quint64 boardSeed;
+    QSettings *settings;
+};
+
+#endif
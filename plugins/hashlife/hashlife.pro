@@ -0,0 +1,11 @@
+TEMPLATE      = lib
+CONFIG       += plugin
+
+QT += opengl
+
+HEADERS       = hashlife.h hashlifeconfig.h hashtree.h
+SOURCES       = hashlife.cpp hashlifeconfig.cpp hashtree.cpp
+
+DESTDIR       = ../../bin/plugins
+
+INCLUDEPATH   += ../../src
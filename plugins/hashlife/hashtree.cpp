@@ -0,0 +1,424 @@
+/*
+  hashtree.cpp
+
+  Copyright (c) 2011, Jeremiah LaRocco jeremiah.larocco@gmail.com
+
+  Permission to use, copy, modify, and/or distribute this software for any
+  purpose with or without fee is hereby granted, provided that the above
+  copyright notice and this permission notice appear in all copies.
+
+  THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+  WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+  MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+  ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+  WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+  ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+  OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+
+#include "hashtree.h"
+
+static const size_t NODE_BLOCK = 4096;
+static const size_t MIN_TABLE = 1 << 16;
+
+// The root has to grow to stepLog+3 levels, and cell coordinates are int64_t
+static const int MAX_STEP_LOG = 58;
+
+static inline size_t hashNodes(const HashNode *nw, const HashNode *ne,
+                               const HashNode *sw, const HashNode *se) {
+    uint64_t h = uint64_t(size_t(nw));
+    h = h*0x9E3779B97F4A7C15ULL + uint64_t(size_t(ne));
+    h = h*0x9E3779B97F4A7C15ULL + uint64_t(size_t(sw));
+    h = h*0x9E3779B97F4A7C15ULL + uint64_t(size_t(se));
+    return size_t(h ^ (h >> 29));
+}
+
+HashTree::HashTree() : root(0), deadLeaf(0), liveLeaf(0), freeList(0),
+                       numNodes(0), budget(size_t(256) << 20), curMark(0),
+                       stepExp(0), gen(0) {
+    clear();
+}
+
+HashTree::~HashTree() {
+    for (size_t i=0; i<blocks.size(); ++i) {
+        delete [] blocks[i];
+    }
+    delete deadLeaf;
+    delete liveLeaf;
+}
+
+void HashTree::clear() {
+    for (size_t i=0; i<blocks.size(); ++i) {
+        delete [] blocks[i];
+    }
+    blocks.clear();
+    freeList = 0;
+    numNodes = 0;
+    table.assign(MIN_TABLE, 0);
+    empties.clear();
+
+    // The two leaves live outside the node store and are never collected
+    if (!deadLeaf) {
+        deadLeaf = new HashNode();
+        liveLeaf = new HashNode();
+        liveLeaf->population = 1;
+    }
+    empties.push_back(deadLeaf);
+
+    root = emptyNode(3);
+    gen = 0;
+}
+
+HashNode *HashTree::leaf(bool alive) {
+    return alive ? liveLeaf : deadLeaf;
+}
+
+HashNode *HashTree::allocNode() {
+    if (!freeList) {
+        HashNode *block = new HashNode[NODE_BLOCK];
+        blocks.push_back(block);
+        for (size_t i=0; i<NODE_BLOCK; ++i) {
+            block[i].next = freeList;
+            freeList = &block[i];
+        }
+    }
+    HashNode *node = freeList;
+    freeList = node->next;
+    return node;
+}
+
+HashNode *HashTree::join(HashNode *nw, HashNode *ne, HashNode *sw, HashNode *se) {
+    size_t slot = hashNodes(nw, ne, sw, se) & (table.size()-1);
+    for (HashNode *node = table[slot]; node; node = node->next) {
+        if (node->nw == nw && node->ne == ne && node->sw == sw && node->se == se) {
+            return node;
+        }
+    }
+
+    HashNode *node = allocNode();
+    node->nw = nw;
+    node->ne = ne;
+    node->sw = sw;
+    node->se = se;
+    node->result = 0;
+    node->population = nw->population + ne->population + sw->population + se->population;
+    node->level = nw->level + 1;
+    node->mark = curMark;
+    node->next = table[slot];
+    table[slot] = node;
+
+    ++numNodes;
+    if (numNodes > table.size()) {
+        rehash(table.size()*2);
+    }
+    return node;
+}
+
+void HashTree::rehash(size_t size) {
+    std::vector<HashNode *> old(size, (HashNode *)0);
+    old.swap(table);
+    for (size_t i=0; i<old.size(); ++i) {
+        HashNode *node = old[i];
+        while (node) {
+            HashNode *next = node->next;
+            size_t slot = hashNodes(node->nw, node->ne, node->sw, node->se) & (table.size()-1);
+            node->next = table[slot];
+            table[slot] = node;
+            node = next;
+        }
+    }
+}
+
+HashNode *HashTree::emptyNode(int level) {
+    while (int(empties.size()) <= level) {
+        HashNode *e = empties.back();
+        empties.push_back(join(e, e, e, e));
+    }
+    return empties[level];
+}
+
+// The same square one level up, surrounded by empty space
+HashNode *HashTree::expand(HashNode *node) {
+    HashNode *e = emptyNode(node->level-1);
+    return join(join(e, e, e, node->nw),
+                join(e, e, node->ne, e),
+                join(e, node->sw, e, e),
+                join(node->se, e, e, e));
+}
+
+// True if every live cell is in the middle quarter of the node
+bool HashTree::centered(HashNode *node) {
+    double inner = node->nw->se->se->population + node->ne->sw->sw->population +
+        node->sw->ne->ne->population + node->se->nw->nw->population;
+    return inner == node->population;
+}
+
+// One generation of the center 2x2 of a 4x4 square
+HashNode *HashTree::lifeBase(HashNode *node) {
+    int cells[4][4];
+    HashNode *quads[2][2] = { { node->nw, node->ne }, { node->sw, node->se } };
+    for (int qy=0; qy<2; ++qy) {
+        for (int qx=0; qx<2; ++qx) {
+            HashNode *q = quads[qy][qx];
+            cells[qy*2][qx*2] = q->nw->population != 0;
+            cells[qy*2][qx*2+1] = q->ne->population != 0;
+            cells[qy*2+1][qx*2] = q->sw->population != 0;
+            cells[qy*2+1][qx*2+1] = q->se->population != 0;
+        }
+    }
+
+    bool next[2][2];
+    for (int y=1; y<3; ++y) {
+        for (int x=1; x<3; ++x) {
+            int num = cells[y-1][x-1] + cells[y-1][x] + cells[y-1][x+1] +
+                cells[y][x-1] + cells[y][x+1] +
+                cells[y+1][x-1] + cells[y+1][x] + cells[y+1][x+1];
+            next[y-1][x-1] = lifeRule.next(cells[y][x], num);
+        }
+    }
+    return join(leaf(next[0][0]), leaf(next[0][1]), leaf(next[1][0]), leaf(next[1][1]));
+}
+
+/*
+  RESULT: the center half of the node advanced 2^j generations, where j is
+  the tree's step clamped to level-2.  The node is split into nine
+  overlapping subsquares one level down.  When j is the full level-2, two
+  rounds of RESULT each advance 2^(j-1); otherwise one round advances the
+  whole 2^j and the centers are stitched back together.
+*/
+HashNode *HashTree::successor(HashNode *node) {
+    if (node->result) {
+        return node->result;
+    }
+    if (node->population == 0) {
+        node->result = emptyNode(node->level-1);
+        return node->result;
+    }
+    if (node->level == 2) {
+        node->result = lifeBase(node);
+        return node->result;
+    }
+
+    HashNode *nw = node->nw, *ne = node->ne, *sw = node->sw, *se = node->se;
+
+    HashNode *c1 = successor(nw);
+    HashNode *c2 = successor(join(nw->ne, ne->nw, nw->se, ne->sw));
+    HashNode *c3 = successor(ne);
+    HashNode *c4 = successor(join(nw->sw, nw->se, sw->nw, sw->ne));
+    HashNode *c5 = successor(join(nw->se, ne->sw, sw->ne, se->nw));
+    HashNode *c6 = successor(join(ne->sw, ne->se, se->nw, se->ne));
+    HashNode *c7 = successor(sw);
+    HashNode *c8 = successor(join(sw->ne, se->nw, sw->se, se->sw));
+    HashNode *c9 = successor(se);
+
+    HashNode *result;
+    if (stepExp < node->level-2) {
+        result = join(join(c1->se, c2->sw, c4->ne, c5->nw),
+                      join(c2->se, c3->sw, c5->ne, c6->nw),
+                      join(c4->se, c5->sw, c7->ne, c8->nw),
+                      join(c5->se, c6->sw, c8->ne, c9->nw));
+    } else {
+        result = join(successor(join(c1, c2, c4, c5)),
+                      successor(join(c2, c3, c5, c6)),
+                      successor(join(c4, c5, c7, c8)),
+                      successor(join(c5, c6, c8, c9)));
+    }
+    node->result = result;
+    return result;
+}
+
+void HashTree::step() {
+    // Grow the root until the pattern can't escape the center half while
+    // it advances
+    while (root->level < stepExp+3 || !centered(root)) {
+        root = expand(root);
+    }
+    root = successor(root);
+    gen += uint64_t(1) << stepExp;
+
+    if (memoryUsed() > budget) {
+        collectGarbage();
+    }
+}
+
+void HashTree::setStepLog(int log) {
+    if (log < 0) log = 0;
+    if (log > MAX_STEP_LOG) log = MAX_STEP_LOG;
+    if (log == stepExp) return;
+
+    stepExp = log;
+    clearResults();
+}
+
+void HashTree::setRule(const LifeRule &newRule) {
+    if (newRule == lifeRule) return;
+
+    lifeRule = newRule;
+    clearResults();
+}
+
+void HashTree::setMemoryBudget(size_t bytes) {
+    budget = bytes;
+}
+
+size_t HashTree::memoryUsed() const {
+    return numNodes*sizeof(HashNode) + table.size()*sizeof(HashNode *);
+}
+
+void HashTree::clearResults() {
+    for (size_t i=0; i<table.size(); ++i) {
+        for (HashNode *node = table[i]; node; node = node->next) {
+            node->result = 0;
+        }
+    }
+    deadLeaf->result = 0;
+    liveLeaf->result = 0;
+}
+
+void HashTree::markNode(HashNode *node) {
+    if (node->mark == curMark || node->level == 0) {
+        return;
+    }
+    node->mark = curMark;
+    markNode(node->nw);
+    markNode(node->ne);
+    markNode(node->sw);
+    markNode(node->se);
+}
+
+/*
+  Keeps the nodes reachable from the root and the empty squares, and
+  returns everything else to the free list.  Memoized results that point
+  at collected nodes are dropped.
+*/
+void HashTree::collectGarbage() {
+    ++curMark;
+    markNode(root);
+    for (size_t i=0; i<empties.size(); ++i) {
+        markNode(empties[i]);
+    }
+
+    for (size_t i=0; i<table.size(); ++i) {
+        HashNode **link = &table[i];
+        while (*link) {
+            HashNode *node = *link;
+            if (node->mark != curMark) {
+                *link = node->next;
+                node->next = freeList;
+                freeList = node;
+                --numNodes;
+            } else {
+                if (node->result && node->result->level > 0 && node->result->mark != curMark) {
+                    node->result = 0;
+                }
+                link = &node->next;
+            }
+        }
+    }
+}
+
+HashNode *HashTree::setCell(HashNode *node, int64_t x, int64_t y, bool alive) {
+    if (node->level == 0) {
+        return leaf(alive);
+    }
+    // Coordinates are relative to the center of the node
+    int64_t offset = node->level >= 2 ? (int64_t(1) << (node->level-2)) : 0;
+    HashNode *nw = node->nw, *ne = node->ne, *sw = node->sw, *se = node->se;
+    if (y < 0) {
+        if (x < 0) {
+            nw = setCell(nw, x+offset, y+offset, alive);
+        } else {
+            ne = setCell(ne, x-offset, y+offset, alive);
+        }
+    } else {
+        if (x < 0) {
+            sw = setCell(sw, x+offset, y-offset, alive);
+        } else {
+            se = setCell(se, x-offset, y-offset, alive);
+        }
+    }
+    return join(nw, ne, sw, se);
+}
+
+void HashTree::setCell(int64_t x, int64_t y, bool alive) {
+    for (;;) {
+        int64_t half = int64_t(1) << (root->level-1);
+        if (x >= -half && x < half && y >= -half && y < half) {
+            break;
+        }
+        root = expand(root);
+    }
+    root = setCell(root, x, y, alive);
+}
+
+bool HashTree::getCell(int64_t x, int64_t y) const {
+    int64_t half = int64_t(1) << (root->level-1);
+    if (x < -half || x >= half || y < -half || y >= half) {
+        return false;
+    }
+    const HashNode *node = root;
+    while (node->level > 0) {
+        if (node->population == 0) {
+            return false;
+        }
+        int64_t offset = node->level >= 2 ? (int64_t(1) << (node->level-2)) : 0;
+        if (y < 0) {
+            y += offset;
+            if (x < 0) {
+                x += offset;
+                node = node->nw;
+            } else {
+                x -= offset;
+                node = node->ne;
+            }
+        } else {
+            y -= offset;
+            if (x < 0) {
+                x += offset;
+                node = node->sw;
+            } else {
+                x -= offset;
+                node = node->se;
+            }
+        }
+    }
+    return node->population != 0;
+}
+
+// Grows the box to cover the live cells of node, whose top left cell is (x, y)
+static void nodeBounds(const HashNode *node, int64_t x, int64_t y, bool &found,
+                       int64_t &minX, int64_t &minY, int64_t &maxX, int64_t &maxY) {
+    if (node->population == 0) {
+        return;
+    }
+    int64_t size = int64_t(1) << node->level;
+    // Nothing in here can grow the box any further
+    if (found && x >= minX && y >= minY && x+size-1 <= maxX && y+size-1 <= maxY) {
+        return;
+    }
+    if (node->level == 0) {
+        if (!found) {
+            minX = maxX = x;
+            minY = maxY = y;
+            found = true;
+        } else {
+            if (x < minX) minX = x;
+            if (x > maxX) maxX = x;
+            if (y < minY) minY = y;
+            if (y > maxY) maxY = y;
+        }
+        return;
+    }
+    int64_t half = size/2;
+    nodeBounds(node->nw, x, y, found, minX, minY, maxX, maxY);
+    nodeBounds(node->ne, x+half, y, found, minX, minY, maxX, maxY);
+    nodeBounds(node->sw, x, y+half, found, minX, minY, maxX, maxY);
+    nodeBounds(node->se, x+half, y+half, found, minX, minY, maxX, maxY);
+}
+
+bool HashTree::bounds(int64_t &minX, int64_t &minY, int64_t &maxX, int64_t &maxY) const {
+    bool found = false;
+    int64_t half = int64_t(1) << (root->level-1);
+    nodeBounds(root, -half, -half, found, minX, minY, maxX, maxY);
+    return found;
+}
@@ -0,0 +1,121 @@
+/*
+  hashtree.h
+
+  Copyright (c) 2011, Jeremiah LaRocco jeremiah.larocco@gmail.com
+
+  Permission to use, copy, modify, and/or distribute this software for any
+  purpose with or without fee is hereby granted, provided that the above
+  copyright notice and this permission notice appear in all copies.
+
+  THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+  WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+  MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+  ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+  WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+  ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+  OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+
+#ifndef HASH_TREE_INCLUDE_H
+#define HASH_TREE_INCLUDE_H
+
+#include <vector>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "liferule.h"
+
+/*
+  A node of the quadtree.  Level 0 nodes are single cells, a level n node
+  is a 2^n x 2^n square made of four level n-1 quadrants.  Nodes are
+  canonical: two squares with the same contents are the same node, so
+  they can be compared and memoized by pointer.
+*/
+struct HashNode {
+    HashNode *nw, *ne, *sw, *se;
+
+    // Center 2^(level-1) square advanced by the tree's current step, or 0
+    HashNode *result;
+
+    // Hash chain, or the free list for unused nodes
+    HashNode *next;
+
+    double population;
+    int level;
+    unsigned int mark;
+};
+
+/*
+  Gosper's HashLife over an unbounded plane.  The root is centered on the
+  origin; step() advances the whole pattern by 2^stepLog() generations.
+*/
+class HashTree {
+public:
+    HashTree();
+    ~HashTree();
+
+    void clear();
+
+    void setCell(int64_t x, int64_t y, bool alive);
+    bool getCell(int64_t x, int64_t y) const;
+
+    // Step size is 2^log generations; changing it drops memoized results
+    void setStepLog(int log);
+    int stepLog() const { return stepExp; }
+
+    // Changing the rule drops memoized results; B0 rules aren't supported
+    void setRule(const LifeRule &newRule);
+    const LifeRule &rule() const { return lifeRule; }
+
+    // Memory the node store may use before step() collects garbage
+    void setMemoryBudget(size_t bytes);
+
+    void step();
+
+    uint64_t generation() const { return gen; }
+    double population() const { return root->population; }
+    HashNode *rootNode() const { return root; }
+
+    size_t nodeCount() const { return numNodes; }
+    size_t memoryUsed() const;
+
+    // Smallest square containing every live cell, false if there are none
+    bool bounds(int64_t &minX, int64_t &minY, int64_t &maxX, int64_t &maxY) const;
+
+    void collectGarbage();
+
+private:
+    HashNode *leaf(bool alive);
+    HashNode *join(HashNode *nw, HashNode *ne, HashNode *sw, HashNode *se);
+    HashNode *emptyNode(int level);
+    HashNode *expand(HashNode *node);
+    bool centered(HashNode *node);
+
+    HashNode *successor(HashNode *node);
+    HashNode *lifeBase(HashNode *node);
+
+    HashNode *setCell(HashNode *node, int64_t x, int64_t y, bool alive);
+
+    HashNode *allocNode();
+    void rehash(size_t size);
+    void markNode(HashNode *node);
+    void clearResults();
+
+    HashNode *root;
+    HashNode *deadLeaf;
+    HashNode *liveLeaf;
+    std::vector<HashNode *> empties;
+
+    std::vector<HashNode *> table;
+    std::vector<HashNode *> blocks;
+    HashNode *freeList;
+    size_t numNodes;
+    size_t budget;
+    unsigned int curMark;
+
+    int stepExp;
+    uint64_t gen;
+    LifeRule lifeRule;
+};
+
+#endif
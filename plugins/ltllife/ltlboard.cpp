@@ -0,0 +1,203 @@
+/*
+  ltlboard.cpp
+
+  Copyright (c) 2011, Jeremiah LaRocco jeremiah.larocco@gmail.com
+
+  Permission to use, copy, modify, and/or distribute this software for any
+  purpose with or without fee is hereby granted, provided that the above
+  copyright notice and this permission notice appear in all copies.
+
+  THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+  WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+  MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+  ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+  WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+  ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+  OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+
+#include <algorithm>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "ltlboard.h"
+
+#include "lifeparallel.h"
+
+// Reads a number at text, or returns false
+static bool readInt(const char *&text, int &value) {
+    if (*text < '0' || *text > '9') {
+        return false;
+    }
+    char *end;
+    value = int(strtol(text, &end, 10));
+    text = end;
+    return true;
+}
+
+// Reads "a..b", or a single number meaning a..a
+static bool readRange(const char *&text, int &low, int &high) {
+    if (!readInt(text, low)) {
+        return false;
+    }
+    high = low;
+    if (text[0] == '.' && text[1] == '.') {
+        text += 2;
+        return readInt(text, high);
+    }
+    return true;
+}
+
+bool LtlRule::parse(const char *text) {
+    LtlRule rule;
+    bool haveRadius = false, haveBirth = false, haveSurvive = false;
+    rule.center = false;
+
+    const char *c = text;
+    while (*c) {
+        char key = *c++;
+        int states = 0, middle = 0;
+        bool ok = true;
+        switch (key) {
+        case 'R': case 'r':
+            ok = readInt(c, rule.radius) && rule.radius >= 1 && rule.radius <= MAX_RADIUS;
+            haveRadius = true;
+            break;
+        case 'C': case 'c':
+            // Only two state rules
+            ok = readInt(c, states) && states <= 2;
+            break;
+        case 'M': case 'm':
+            ok = readInt(c, middle) && middle <= 1;
+            rule.center = middle == 1;
+            break;
+        case 'S': case 's':
+            ok = readRange(c, rule.surviveMin, rule.surviveMax);
+            haveSurvive = true;
+            break;
+        case 'B': case 'b':
+            ok = readRange(c, rule.birthMin, rule.birthMax);
+            haveBirth = true;
+            break;
+        case 'N': case 'n':
+            // Only the Moore (square) neighborhood
+            ok = *c == 'M' || *c == 'm';
+            if (ok) ++c;
+            break;
+        case ',': case ' ':
+            break;
+        default:
+            ok = false;
+        }
+        if (!ok) {
+            return false;
+        }
+    }
+    if (!haveRadius || !haveBirth || !haveSurvive) {
+        return false;
+    }
+    *this = rule;
+    return true;
+}
+
+std::string LtlRule::toString() const {
+    char text[128];
+    snprintf(text, sizeof(text), "R%d,C0,M%d,S%d..%d,B%d..%d,NM",
+             radius, center ? 1 : 0, surviveMin, surviveMax, birthMin, birthMax);
+    return text;
+}
+
+LtlBoard::LtlBoard() : w(0), h(0), pw(0), ph(0) {
+}
+
+void LtlBoard::resize(int width, int height) {
+    w = width;
+    h = height;
+    cells.assign(w*h, 0);
+    next.assign(w*h, 0);
+    layoutSums();
+}
+
+void LtlBoard::clear() {
+    std::fill(cells.begin(), cells.end(), 0);
+}
+
+void LtlBoard::setRule(const LtlRule &rule) {
+    ltlRule = rule;
+    layoutSums();
+}
+
+void LtlBoard::layoutSums() {
+    if (w == 0 || h == 0) {
+        pw = ph = 0;
+        colMap.clear();
+        sums.clear();
+        return;
+    }
+    int r = ltlRule.radius;
+    pw = w + 2*r;
+    ph = h + 2*r;
+    colMap.resize(pw);
+    for (int x=0; x<pw; ++x) {
+        colMap[x] = (((x - r) % w) + w) % w;
+    }
+    // Row and column 0 stay zero
+    sums.assign((pw+1)*(ph+1), 0);
+}
+
+void LtlBoard::evolve() {
+    if (cells.empty()) return;
+
+    // Running sums along each padded row, then down each column
+    parallelBands(ph, this, &LtlBoard::sumRows, 16384/qMax(pw, 1) + 1);
+    parallelBands(pw, this, &LtlBoard::sumColumns, 64);
+    parallelBands(h, this, &LtlBoard::evolveRows, 16384/qMax(w, 1) + 1);
+
+    cells.swap(next);
+}
+
+void LtlBoard::sumRows(int begin, int end) {
+    int r = ltlRule.radius;
+    for (int y=begin; y<end; ++y) {
+        const unsigned char *row = &cells[((((y - r) % h) + h) % h)*w];
+        uint32_t *out = &sums[(y+1)*(pw+1)];
+        uint32_t total = 0;
+        for (int x=0; x<pw; ++x) {
+            total += row[colMap[x]];
+            out[x+1] = total;
+        }
+    }
+}
+
+void LtlBoard::sumColumns(int begin, int end) {
+    // Column x of the board is column x+1 of the table
+    for (int y=1; y<ph; ++y) {
+        const uint32_t *above = &sums[y*(pw+1) + 1];
+        uint32_t *out = &sums[(y+1)*(pw+1) + 1];
+        for (int x=begin; x<end; ++x) {
+            out[x] += above[x];
+        }
+    }
+}
+
+void LtlBoard::evolveRows(int begin, int end) {
+    int side = 2*ltlRule.radius + 1;
+    int stride = pw+1;
+    bool center = ltlRule.center;
+
+    for (int i=begin; i<end; ++i) {
+        // Board cell (i, j) is padded cell (i+r, j+r), so its square runs
+        // from padded (i, j) to (i+side-1, j+side-1)
+        const uint32_t *top = &sums[i*stride];
+        const uint32_t *bottom = &sums[(i+side)*stride];
+        const unsigned char *cur = &cells[i*w];
+        unsigned char *out = &next[i*w];
+        for (int j=0; j<w; ++j) {
+            int num = int(bottom[j+side] - bottom[j] - top[j+side] + top[j]);
+            if (!center) {
+                num -= cur[j];
+            }
+            out[j] = ltlRule.next(cur[j] != 0, num);
+        }
+    }
+}
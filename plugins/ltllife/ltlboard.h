@@ -0,0 +1,98 @@
+/*
+  ltlboard.h
+
+  Copyright (c) 2011, Jeremiah LaRocco jeremiah.larocco@gmail.com
+
+  Permission to use, copy, modify, and/or distribute this software for any
+  purpose with or without fee is hereby granted, provided that the above
+  copyright notice and this permission notice appear in all copies.
+
+  THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+  WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+  MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+  ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+  WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+  ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+  OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+
+#ifndef LTL_BOARD_INCLUDE_H
+#define LTL_BOARD_INCLUDE_H
+
+#include <string>
+#include <vector>
+#include <stdint.h>
+
+/*
+  A Larger than Life rule: cells count the live cells in the
+  (2*radius+1)^2 square around them, including themselves when center is
+  set.  Written the way Golly does, e.g. "R5,C0,M1,S34..58,B34..45".
+*/
+struct LtlRule {
+    static const int MAX_RADIUS = 50;
+
+    int radius;
+    bool center;
+    int birthMin, birthMax;
+    int surviveMin, surviveMax;
+
+    // Bosco's rule
+    LtlRule() : radius(5), center(true), birthMin(34), birthMax(45),
+                surviveMin(34), surviveMax(58) {}
+
+    bool next(bool alive, int num) const {
+        return alive ? (num >= surviveMin && num <= surviveMax) :
+            (num >= birthMin && num <= birthMax);
+    }
+
+    // Leaves the rule alone and returns false if text isn't a valid rule
+    bool parse(const char *text);
+    std::string toString() const;
+};
+
+/*
+  A torus of cells evolved under a Larger than Life rule.  Neighbor counts
+  come from a summed-area table over the board padded by radius cells of
+  wrapped neighbors on every side, so each cell costs four lookups no
+  matter how large the radius is.
+*/
+class LtlBoard {
+public:
+    LtlBoard();
+
+    void resize(int width, int height);
+    void clear();
+
+    int width() const { return w; }
+    int height() const { return h; }
+
+    bool get(int row, int col) const { return cells[row*w + col] != 0; }
+    void set(int row, int col, bool alive) { cells[row*w + col] = alive; }
+
+    void setRule(const LtlRule &rule);
+    const LtlRule &rule() const { return ltlRule; }
+
+    void evolve();
+
+private:
+    void layoutSums();
+    void sumRows(int begin, int end);
+    void sumColumns(int begin, int end);
+    void evolveRows(int begin, int end);
+
+    int w, h;
+    LtlRule ltlRule;
+
+    std::vector<unsigned char> cells;
+    std::vector<unsigned char> next;
+
+    // Padded size, and the board column each padded column wraps to
+    int pw, ph;
+    std::vector<int> colMap;
+
+    // sums[y*(pw+1) + x] is the number of live cells above and left of
+    // padded cell (y, x)
+    std::vector<uint32_t> sums;
+};
+
+#endif
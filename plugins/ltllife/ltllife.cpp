@@ -0,0 +1,214 @@
+/*
+  ltllife.cpp
+
+  Copyright (c) 2011, Jeremiah LaRocco jeremiah.larocco@gmail.com
+
+  Permission to use, copy, modify, and/or distribute this software for any
+  purpose with or without fee is hereby granted, provided that the above
+  copyright notice and this permission notice appear in all copies.
+
+  THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+  WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+  MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+  ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+  WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+  ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+  OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+
+#include <QtGui>
+#include <QDebug>
+
+#include <QSettings>
+
+#include <cstdlib>
+
+#include "ltllife.h"
+
+#include "lifeparallel.h"
+
+#include "ltllifeconfig.h"
+
+LtlLife::LtlLife() : width(256), height(256), prob(0.5), r(0),g(1),b(1),
+                     seed(0), boardSeed(0), fillBits(0), settings(0) {
+}
+
+void LtlLife::readSettings(QSettings *sets) {
+    settings = sets;
+
+    width = sets->value("ltl_width", 256).toInt();
+    height = sets->value("ltl_height", 256).toInt();
+
+    prob = sets->value("ltl_initial_fill", 0.5).toFloat();
+
+    r = sets->value("ltl_red", 0.0).toFloat();
+    g = sets->value("ltl_green", 0.8).toFloat();
+    b = sets->value("ltl_blue", 0.4).toFloat();
+
+    LtlRule newRule;
+    if (newRule.parse(sets->value("ltl_rule", QString::fromLatin1(LtlRule().toString().c_str())).toString().toLatin1().constData())) {
+        setRule(newRule);
+    }
+
+    seed = sets->value("ltl_seed", 0).toULongLong();
+
+    reset();
+}
+
+void LtlLife::configure(QWidget *parent, QSettings *sets) {
+    LtlLifeConfig *cfgDlg = new LtlLifeConfig(this, sets, parent);
+    cfgDlg->show();
+}
+
+LtlLife::~LtlLife() {
+    board.resize(0, 0);
+}
+
+QString LtlLife::name() {
+    return tr("Larger than Life");
+}
+
+QString LtlLife::description() {
+    return tr("Outer totalistic rules over a large square neighborhood, counted with a summed-area table.");
+}
+
+QString LtlLife::engineInfo() {
+    return tr("Larger than Life, %1, seed %2")
+        .arg(QString::fromLatin1(board.rule().toString().c_str()))
+        .arg(boardSeed);
+}
+
+double LtlLife::population() {
+    double total = 0;
+    for (int i=0; i<board.height(); ++i) {
+        for (int j=0; j<board.width(); ++j) {
+            total += board.get(i, j);
+        }
+    }
+    return total;
+}
+
+bool LtlLife::allowViewManipulation() {
+    return false;
+}
+
+void LtlLife::initView() {
+    glClearColor(0,0,0,0);
+    glShadeModel(GL_SMOOTH);
+    glDisable(GL_LIGHTING);
+
+    glDisable(GL_LIGHT0);
+}
+
+void LtlLife::resizeView(int width, int height) {
+    glViewport(0,0, (GLsizei) width, (GLsizei)height);
+    glMatrixMode(GL_PROJECTION);
+    glLoadIdentity();
+    gluOrtho2D(0, 100,
+               0, 100);
+
+    glMatrixMode(GL_MODELVIEW);
+
+    glClear(GL_COLOR_BUFFER_BIT);
+}
+
+bool LtlLife::evolve() {
+    board.evolve();
+    return false;
+}
+
+void LtlLife::draw() {
+    glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+    glPolygonMode(GL_FRONT_AND_BACK, GL_FILL);
+    float dx = 100.0/width;
+    float dy = 100.0/height;
+
+    glColor3f(r,g,b);
+    glBegin(GL_QUADS);
+    for (int i=0; i < height; ++i) {
+        float cy = i*dy;
+        for (int j=0; j<width; ++j) {
+            if (board.get(i,j)) {
+                float cx = j*dx;
+                glVertex2f(cx, cy);
+                glVertex2f(cx+dx, cy);
+                glVertex2f(cx+dx, cy+dy);
+                glVertex2f(cx, cy+dy);
+            }
+        }
+    }
+    glEnd();
+    glFlush();
+}
+
+void LtlLife::reset() {
+    board.resize(width, height);
+
+    boardSeed = seed ? seed : lifeNewSeed();
+    if (settings) {
+        settings->setValue("ltl_last_seed", boardSeed);
+    }
+    LifeBernoulli bits(boardSeed, prob);
+    fillBits = &bits;
+    parallelBands(height, this, &LtlLife::fillRows, 16384/qMax(width, 1) + 1);
+    fillBits = 0;
+}
+
+void LtlLife::fillRows(int begin, int end) {
+    int words = (width+63)/64;
+    for (int i=begin; i<end; ++i) {
+        for (int k=0; k<words; ++k) {
+            uint64_t word = fillBits->word(uint64_t(i)*words + k);
+            int bits = qMin(64, width - 64*k);
+            for (int n=0; n<bits; ++n) {
+                board.set(i, 64*k + n, (word >> n) & 1);
+            }
+        }
+    }
+}
+
+void LtlLife::setRGB(double red, double green, double blue) {
+    r = red;
+    g = green;
+    b = blue;
+}
+
+void LtlLife::getRGB(double &red, double &green, double &blue) {
+    red = r;
+    green = g;
+    blue = b;
+}
+
+void LtlLife::setProb(double probability) {
+    prob = probability;
+}
+
+void LtlLife::getProb(double &probability) {
+    probability = prob;
+}
+
+void LtlLife::setDim(int w, int h) {
+    width = w;
+    height = h;
+}
+void LtlLife::getDim(int &w, int &h) {
+    w = width;
+    h = height;
+}
+
+void LtlLife::setRule(const LtlRule &newRule) {
+    board.setRule(newRule);
+}
+void LtlLife::getRule(LtlRule &curRule) {
+    curRule = board.rule();
+}
+
+void LtlLife::setSeed(quint64 newSeed) {
+    seed = newSeed;
+}
+void LtlLife::getSeed(quint64 &curSeed) {
+    curSeed = seed;
+}
+
+
+Q_EXPORT_PLUGIN2(ltllife, LtlLife)
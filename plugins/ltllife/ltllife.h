@@ -0,0 +1,94 @@
+/*
+  ltllife.h
+
+  Copyright (c) 2011, Jeremiah LaRocco jeremiah.larocco@gmail.com
+
+  Permission to use, copy, modify, and/or distribute this software for any
+  purpose with or without fee is hereby granted, provided that the above
+  copyright notice and this permission notice appear in all copies.
+
+  THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+  WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+  MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+  ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+  WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+  ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+  OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+
+#ifndef LTL_LIFE_INCLUDE_H
+#define LTL_LIFE_INCLUDE_H
+
+#include <QObject>
+#include <QWidget>
+
+#ifdef __APPLE_CC__
+#include <OpenGL/gl.h>
+#include <OpenGL/glu.h>
+#else
+#include <GL/gl.h>
+#include <GL/glu.h>
+#endif
+
+#include "lifeplugin.h"
+#include "liferandom.h"
+
+#include "ltlboard.h"
+
+class LtlLife : public QObject, public LifePlugin {
+    Q_OBJECT;
+    Q_INTERFACES(LifePlugin);
+
+public:
+    LtlLife();
+    ~LtlLife();
+
+    virtual QString name();
+    virtual QString description();
+
+    virtual bool allowViewManipulation();
+    virtual void initView();
+    virtual void resizeView(int width, int height);
+    virtual bool evolve();
+    virtual void draw();
+    virtual void reset();
+
+    virtual void readSettings(QSettings *sets);
+    virtual void configure(QWidget *parent, QSettings *sets);
+
+    virtual QString engineInfo();
+    virtual double population();
+
+    void setRGB(double red, double green, double blue);
+    void getRGB(double &red, double &green, double &blue);
+
+    void setProb(double probability);
+    void getProb(double &prob);
+
+    void setDim(int w, int h);
+    void getDim(int &w, int &h);
+
+    void setRule(const LtlRule &newRule);
+    void getRule(LtlRule &curRule);
+
+    // Boards are filled from this seed, or a new one each reset() if 0
+    void setSeed(quint64 newSeed);
+    void getSeed(quint64 &curSeed);
+
+private:
+    void fillRows(int begin, int end);
+
+private:
+    LtlBoard board;
+    int width, height;
+    double prob;
+    double r,g,b;
+
+    quint64 seed;
+    // Seed of the current board, saved as ltl_last_seed
+    quint64 boardSeed;
+    const LifeBernoulli *fillBits;
+    QSettings *settings;
+};
+
+#endif
@@ -0,0 +1,11 @@
+TEMPLATE      = lib
+CONFIG       += plugin
+
+QT += opengl
+
+HEADERS       = ltllife.h ltllifeconfig.h ltlboard.h
+SOURCES       = ltllife.cpp ltllifeconfig.cpp ltlboard.cpp
+
+DESTDIR       = ../../bin/plugins
+
+INCLUDEPATH   += ../../src
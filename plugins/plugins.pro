@@ -1,6 +1,6 @@
 
 TEMPLATE = subdirs
 
-SUBDIRS += simplelife threedimlife growlife
+SUBDIRS += simplelife threedimlife growlife hashlife sparselife ltllife genlife
 
 
@@ -0,0 +1,394 @@
+/*
+  bitboard.cpp
+
+  Copyright (c) 2011, Jeremiah LaRocco jeremiah.larocco@gmail.com
+
+  Permission to use, copy, modify, and/or distribute this software for any
+  purpose with or without fee is hereby granted, provided that the above
+  copyright notice and this permission notice appear in all copies.
+
+  THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+  WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+  MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+  ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+  WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+  ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+  OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+
+#include <algorithm>
+
+#include "bitboard.h"
+
+#include "lifeparallel.h"
+#include "lifehistory.h"
+
+BitBoard::BitBoard() : w(0), h(0), words(0), lastMask(0),
+                       kernelInfo(scalarRowKernel()),
+                       kernel(kernelInfo.kernels[lifeRule.kind()]), allocs(0),
+                       tableFilled(false), fillBits(0),
+                       tilesX(0), tilesY(0), numActive(0), allDirty(true),
+                       hashesStale(true), evolvesSinceHash(0) {
+}
+
+void BitBoard::resize(int width, int height) {
+    w = width;
+    h = height;
+    words = (w+63)/64;
+    lastMask = (w%64) ? ((uint64_t(1) << (w%64)) - 1) : ~uint64_t(0);
+
+    cells.assign(words*h, 0);
+    next.assign(words*h, 0);
+    padded.clear();
+    if (words*h > 0) {
+        allocs += 2;
+    }
+
+    tilesX = words;
+    tilesY = (h+TILE_ROWS-1)/TILE_ROWS;
+    changed.assign(tilesX*tilesY, 0);
+    nextChanged.assign(tilesX*tilesY, 0);
+    active.assign(tilesX*tilesY, 0);
+    activeInRow.assign(tilesY, 0);
+    numActive = 0;
+    allDirty = true;
+    tileHashes.assign(tilesX*tilesY, 0);
+    hashesStale = true;
+}
+
+void BitBoard::clear() {
+    std::fill(cells.begin(), cells.end(), 0);
+    allDirty = true;
+    hashesStale = true;
+}
+
+void BitBoard::set(int row, int col, bool alive) {
+    uint64_t bit = uint64_t(1) << (col&63);
+    if (alive) {
+        cells[row*words + (col>>6)] |= bit;
+    } else {
+        cells[row*words + (col>>6)] &= ~bit;
+    }
+    // The back buffer no longer matches, so everything has to be evolved
+    allDirty = true;
+    hashesStale = true;
+}
+
+void BitBoard::fillRandom(const LifeBernoulli &bits) {
+    fillBits = &bits;
+    parallelBands(h, this, &BitBoard::fillRows, 4096/qMax(words, 1) + 1);
+    fillBits = 0;
+    allDirty = true;
+    hashesStale = true;
+}
+
+void BitBoard::fillRows(int begin, int end) {
+    for (int i=begin; i<end; ++i) {
+        uint64_t *row = &cells[i*words];
+        for (int k=0; k<words; ++k) {
+            row[k] = fillBits->word(uint64_t(i)*words + k);
+        }
+        row[words-1] &= lastMask;
+    }
+}
+
+void BitBoard::setKernel(const RowKernelInfo &info) {
+    kernelInfo = info;
+    kernel = kernelInfo.kernels[lifeRule.kind()];
+}
+
+void BitBoard::setRule(const LifeRule &rule) {
+    lifeRule = rule;
+    kernel = kernelInfo.kernels[lifeRule.kind()];
+    tableFilled = false;
+    // Unchanged tiles don't stay unchanged under a different rule
+    allDirty = true;
+}
+
+void BitBoard::evolve() {
+    if (cells.empty()) return;
+
+    markActiveTiles();
+
+    // Keep bands to at least a few thousand words so small boards stay
+    // on one thread
+    parallelBands(tilesY, this, &BitBoard::evolveTileRows, 4096/qMax(words*TILE_ROWS, 1) + 1);
+
+    cells.swap(next);
+    changed.swap(nextChanged);
+    allDirty = false;
+    ++evolvesSinceHash;
+}
+
+void BitBoard::evolveTable() {
+    if (cells.empty()) return;
+
+    if (padded.empty()) {
+        padded.assign((words+1)*h, 0);
+        ++allocs;
+    }
+    if (!tableFilled) {
+        table.resize(65536);
+        fillLifeTable(&table[0], lifeRule);
+        tableFilled = true;
+    }
+
+    parallelBands(h, this, &BitBoard::padRows, 4096/qMax(words, 1) + 1);
+    parallelBands((h+1)/2, this, &BitBoard::evolveTablePairs, 2048/qMax(words, 1) + 1);
+
+    cells.swap(next);
+    // The tiles weren't tracked, so the next evolve() has to do them all
+    allDirty = true;
+    hashesStale = true;
+}
+
+bool BitBoard::tileRowChanged(int ty) const {
+    if (allDirty) {
+        return true;
+    }
+    const unsigned char *chg = &changed[ty*tilesX];
+    for (int tx=0; tx<tilesX; ++tx) {
+        if (chg[tx]) {
+            return true;
+        }
+    }
+    return false;
+}
+
+void BitBoard::blockCounts(int level, int blockRow, int firstBlock, int blocks, uint32_t *out) const {
+    std::fill(out, out + blocks, 0);
+
+    // Words holding the blocks
+    int firstWord, endWord;
+    if (level >= 6) {
+        firstWord = firstBlock << (level-6);
+        endWord = std::min(words, (firstBlock + blocks) << (level-6));
+    } else {
+        firstWord = firstBlock >> (6-level);
+        endWord = std::min(words, ((firstBlock + blocks - 1) >> (6-level)) + 1);
+    }
+
+    int size = 1 << level;
+    int rowEnd = std::min(h, (blockRow+1) << level);
+    for (int i=blockRow << level; i<rowEnd; ++i) {
+        const uint64_t *row = &cells[i*words];
+        if (level >= 6) {
+            // Blocks of whole words
+            for (int k=firstWord; k<endWord; ++k) {
+                out[(k >> (level-6)) - firstBlock] += __builtin_popcountll(row[k]);
+            }
+            continue;
+        }
+        uint64_t mask = (uint64_t(1) << size) - 1;
+        for (int k=firstWord; k<endWord; ++k) {
+            uint64_t word = row[k];
+            int block = (k << (6-level)) - firstBlock;
+            for (; word; ++block, word >>= size) {
+                if (block >= 0 && block < blocks) {
+                    out[block] += __builtin_popcountll(word & mask);
+                }
+            }
+        }
+    }
+}
+
+uint64_t BitBoard::population() const {
+    // Bits past the last column are always clear
+    uint64_t total = 0;
+    for (size_t k=0; k<cells.size(); ++k) {
+        total += __builtin_popcountll(cells[k]);
+    }
+    return total;
+}
+
+uint64_t BitBoard::hash() {
+    if (evolvesSinceHash > 1) {
+        hashesStale = true;
+    }
+    parallelBands(tilesY, this, &BitBoard::hashTileRows, 16384/qMax(words*TILE_ROWS, 1) + 1);
+    hashesStale = false;
+    evolvesSinceHash = 0;
+
+    uint64_t total = 0;
+    for (size_t t=0; t<tileHashes.size(); ++t) {
+        total ^= tileHashes[t];
+    }
+    return total;
+}
+
+void BitBoard::hashTileRows(int begin, int end) {
+    for (int ty=begin; ty<end; ++ty) {
+        int rowEnd = std::min(h, (ty+1)*TILE_ROWS);
+        for (int tx=0; tx<tilesX; ++tx) {
+            int t = ty*tilesX + tx;
+            if (!hashesStale && !changed[t]) {
+                continue;
+            }
+            // Seeded with the tile's position so equal tiles in different
+            // places don't cancel out
+            uint64_t sum = lifeMix64(t + 1);
+            for (int i=ty*TILE_ROWS; i<rowEnd; ++i) {
+                sum = sum*0x9e3779b97f4a7c15ULL + cells[i*words + tx];
+            }
+            tileHashes[t] = lifeMix64(sum);
+        }
+    }
+}
+
+/*
+  Copies rows shifted up one bit, with the last column wrapped into bit 0
+  and the first two columns after the end of the row.
+*/
+void BitBoard::padRows(int begin, int end) {
+    int pw = words+1;
+    for (int i=begin; i<end; ++i) {
+        const uint64_t *src = &cells[i*words];
+        uint64_t *dst = &padded[i*pw];
+
+        uint64_t carry = (src[(w-1)>>6] >> ((w-1)&63)) & 1;
+        for (int k=0; k<words; ++k) {
+            dst[k] = (src[k] << 1) | carry;
+            carry = src[k] >> 63;
+        }
+        dst[words] = carry;
+
+        dst[(w+1)>>6] |= (src[0] & 1) << ((w+1)&63);
+        dst[(w+2)>>6] |= ((src[(1%w)>>6] >> ((1%w)&63)) & 1) << ((w+2)&63);
+    }
+}
+
+void BitBoard::evolveTablePairs(int begin, int end) {
+    int pw = words+1;
+    for (int p=begin; p<end; ++p) {
+        int i = 2*p;
+        const uint64_t *r0 = &padded[(i>0 ? i-1 : h-1)*pw];
+        const uint64_t *r1 = &padded[i*pw];
+        const uint64_t *r2 = &padded[((i+1)%h)*pw];
+        const uint64_t *r3 = &padded[((i+2)%h)*pw];
+        uint64_t *out0 = &next[i*words];
+        uint64_t *out1 = i+1<h ? &next[(i+1)*words] : 0;
+
+        tableRowPair(&table[0], r0, r1, r2, r3, out0, out1, words);
+
+        // The pair past an odd width computes a column that doesn't exist
+        out0[words-1] &= lastMask;
+        if (out1) {
+            out1[words-1] &= lastMask;
+        }
+    }
+}
+
+void BitBoard::markActiveTiles() {
+    numActive = 0;
+    for (int ty=0; ty<tilesY; ++ty) {
+        int rowActive = 0;
+        int up = ty>0 ? ty-1 : tilesY-1;
+        int down = ty+1<tilesY ? ty+1 : 0;
+        for (int tx=0; tx<tilesX; ++tx) {
+            int left = tx>0 ? tx-1 : tilesX-1;
+            int right = tx+1<tilesX ? tx+1 : 0;
+
+            bool act = allDirty ||
+                changed[up*tilesX + left] || changed[up*tilesX + tx] || changed[up*tilesX + right] ||
+                changed[ty*tilesX + left] || changed[ty*tilesX + tx] || changed[ty*tilesX + right] ||
+                changed[down*tilesX + left] || changed[down*tilesX + tx] || changed[down*tilesX + right];
+
+            active[ty*tilesX + tx] = act;
+            rowActive += act;
+        }
+        activeInRow[ty] = rowActive;
+        numActive += rowActive;
+    }
+}
+
+void BitBoard::evolveTileRows(int begin, int end) {
+    for (int ty=begin; ty<end; ++ty) {
+        const unsigned char *act = &active[ty*tilesX];
+        unsigned char *chg = &nextChanged[ty*tilesX];
+        std::fill(chg, chg+tilesX, 0);
+        if (activeInRow[ty] == 0) {
+            continue;
+        }
+
+        int rowEnd = std::min(h, (ty+1)*TILE_ROWS);
+        for (int i=ty*TILE_ROWS; i<rowEnd; ++i) {
+            const uint64_t *up = &cells[(i>0 ? i-1 : h-1)*words];
+            const uint64_t *cur = &cells[i*words];
+            const uint64_t *down = &cells[(i+1<h ? i+1 : 0)*words];
+            uint64_t *out = &next[i*words];
+
+            // Evolve each run of neighboring active tiles in one go
+            int k = 0;
+            while (k < words) {
+                if (!act[k]) {
+                    ++k;
+                    continue;
+                }
+                int runEnd = k+1;
+                while (runEnd < words && act[runEnd]) {
+                    ++runEnd;
+                }
+                evolveSpan(up, cur, down, out, k, runEnd);
+                for (int t=k; t<runEnd; ++t) {
+                    chg[t] |= (out[t] != cur[t]);
+                }
+                k = runEnd;
+            }
+        }
+    }
+}
+
+void BitBoard::evolveSpan(const uint64_t *up, const uint64_t *cur,
+                          const uint64_t *down, uint64_t *out,
+                          int begin, int end) const {
+    int interiorBegin = std::max(begin, 1);
+    int interiorEnd = std::min(end, words-1);
+    if (interiorBegin < interiorEnd) {
+        kernel(up, cur, down, out, interiorBegin, interiorEnd, lifeRule);
+    }
+    if (begin == 0) {
+        out[0] = edgeWord(up, cur, down, 0);
+    }
+    if (end == words && words > 1) {
+        out[words-1] = edgeWord(up, cur, down, words-1);
+    }
+}
+uint64_t BitBoard::edgeWord(const uint64_t *up, const uint64_t *cur,
+                            const uint64_t *down, int k) const {
+    // Bits shifted in at the left and right edges of the row wrap around
+    int lastBit = (w-1)&63;
+
+    uint64_t upWest, curWest, downWest;
+    if (k > 0) {
+        upWest = up[k-1] >> 63;
+        curWest = cur[k-1] >> 63;
+        downWest = down[k-1] >> 63;
+    } else {
+        upWest = up[words-1] >> lastBit;
+        curWest = cur[words-1] >> lastBit;
+        downWest = down[words-1] >> lastBit;
+    }
+
+    uint64_t upEast, curEast, downEast;
+    if (k+1 < words) {
+        upEast = up[k+1] << 63;
+        curEast = cur[k+1] << 63;
+        downEast = down[k+1] << 63;
+    } else {
+        upEast = (up[0] & 1) << lastBit;
+        curEast = (cur[0] & 1) << lastBit;
+        downEast = (down[0] & 1) << lastBit;
+    }
+
+    uint64_t u = up[k];
+    uint64_t m = cur[k];
+    uint64_t d = down[k];
+    uint64_t result = ruleWord(MaskRule(lifeRule),
+                               (u << 1) | upWest, u, (u >> 1) | upEast,
+                               (m << 1) | curWest, m, (m >> 1) | curEast,
+                               (d << 1) | downWest, d, (d >> 1) | downEast);
+    if (k+1 == words) {
+        result &= lastMask;
+    }
+    return result;
+}
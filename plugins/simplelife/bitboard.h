@@ -0,0 +1,145 @@
+/*
+  bitboard.h
+
+  Copyright (c) 2011, Jeremiah LaRocco jeremiah.larocco@gmail.com
+
+  Permission to use, copy, modify, and/or distribute this software for any
+  purpose with or without fee is hereby granted, provided that the above
+  copyright notice and this permission notice appear in all copies.
+
+  THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+  WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+  MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+  ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+  WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+  ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+  OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+
+#ifndef BIT_BOARD_INCLUDE_H
+#define BIT_BOARD_INCLUDE_H
+
+#include <vector>
+#include <stdint.h>
+
+#include "lifebits.h"
+#include "liferandom.h"
+#include "lifekernels.h"
+#include "lifetable.h"
+
+/*
+  A torus of cells packed 64 to a word.  Bit n of word k in a row holds
+  column 64*k+n; unused bits in the last word of each row are always zero.
+
+  The board is split into tiles one word wide and TILE_ROWS rows tall.  A
+  tile is only evolved when it or one of its neighbors changed in the last
+  generation.  Skipped tiles need no copying: since they didn't change, the
+  back buffer already holds the same cells as the front buffer.
+*/
+class BitBoard {
+public:
+    BitBoard();
+
+    void resize(int width, int height);
+    void clear();
+
+    int width() const { return w; }
+    int height() const { return h; }
+
+    // Number of times the two cell buffers have been allocated
+    int allocations() const { return allocs; }
+
+    bool get(int row, int col) const {
+        return (cells[row*words + (col>>6)] >> (col&63)) & 1;
+    }
+    void set(int row, int col, bool alive);
+
+    // Replaces every cell with word row*words + k of the stream, in parallel
+    void fillRandom(const LifeBernoulli &bits);
+
+    void setKernel(const RowKernelInfo &info);
+    const char *kernelName() const { return kernelInfo.name; }
+
+    void setRule(const LifeRule &rule);
+    const LifeRule &rule() const { return lifeRule; }
+
+    void evolve();
+
+    // One generation with the 4x4 lookup table instead of the row kernels
+    void evolveTable();
+
+    static const int TILE_ROWS = 64;
+
+    // Tiles evolved by the last call to evolve()
+    int activeTiles() const { return numActive; }
+    int tileCount() const { return tilesX*tilesY; }
+
+    // Whether any tile in tile row ty changed in the last generation;
+    // always true when changes weren't tracked
+    bool tileRowChanged(int ty) const;
+
+    // Live cells in blocks [firstBlock, firstBlock+blocks) of block row
+    // blockRow, where blocks are 2^level cells square, for drawing the part
+    // of the board in view at a level of detail
+    void blockCounts(int level, int blockRow, int firstBlock, int blocks, uint32_t *out) const;
+
+    // Live cells
+    uint64_t population() const;
+
+    // Hash of the cells.  Each tile's hash is kept and only tiles that
+    // changed are hashed again, so calling this after every evolve() is
+    // cheap once most of the board has settled.
+    uint64_t hash();
+
+private:
+    void markActiveTiles();
+    void evolveTileRows(int begin, int end);
+    void evolveSpan(const uint64_t *up, const uint64_t *cur,
+                    const uint64_t *down, uint64_t *out,
+                    int begin, int end) const;
+    uint64_t edgeWord(const uint64_t *up, const uint64_t *cur,
+                      const uint64_t *down, int k) const;
+
+    void hashTileRows(int begin, int end);
+    void fillRows(int begin, int end);
+
+    void padRows(int begin, int end);
+    void evolveTablePairs(int begin, int end);
+
+    int w, h;
+    int words;
+    uint64_t lastMask;
+
+    RowKernelInfo kernelInfo;
+    LifeRule lifeRule;
+    // Kernel from kernelInfo for lifeRule
+    RowKernel kernel;
+    int allocs;
+
+    std::vector<uint64_t> cells;
+    std::vector<uint64_t> next;
+
+    // Rows padded for the lookup table, and the table, allocated on first use
+    std::vector<uint64_t> padded;
+    std::vector<uint8_t> table;
+    bool tableFilled;
+
+    // Stream fillRandom() is copying from
+    const LifeBernoulli *fillBits;
+
+    int tilesX, tilesY;
+    int numActive;
+    bool allDirty;
+    std::vector<unsigned char> changed;
+    std::vector<unsigned char> nextChanged;
+    std::vector<unsigned char> active;
+    std::vector<int> activeInRow;
+
+    // Per tile hashes, and whether the changed flags still describe every
+    // change since they were computed
+    std::vector<uint64_t> tileHashes;
+    bool hashesStale;
+    int evolvesSinceHash;
+};
+
+#endif
@@ -0,0 +1,236 @@
+/*
+  lifekernels.cpp
+
+  Copyright (c) 2011, Jeremiah LaRocco jeremiah.larocco@gmail.com
+
+  Permission to use, copy, modify, and/or distribute this software for any
+  purpose with or without fee is hereby granted, provided that the above
+  copyright notice and this permission notice appear in all copies.
+
+  THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+  WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+  MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+  ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+  WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+  ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+  OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+
+// The vector kernels are built with per-function target attributes so the
+// plugin itself doesn't need -mavx2 and still loads on older CPUs.
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define LIFE_X86_KERNELS
+#include <immintrin.h>
+#endif
+
+#include "lifekernels.h"
+#include "lifebits.h"
+
+template <class Rule>
+static void scalarRow(const uint64_t *up, const uint64_t *cur,
+                      const uint64_t *down, uint64_t *out,
+                      int begin, int end, const LifeRule &rule) {
+    Rule r(rule);
+    for (int k=begin; k<end; ++k) {
+        uint64_t u = up[k];
+        uint64_t m = cur[k];
+        uint64_t d = down[k];
+        out[k] = ruleWord(r, (u << 1) | (up[k-1] >> 63), u, (u >> 1) | (up[k+1] << 63),
+                         (m << 1) | (cur[k-1] >> 63), m, (m >> 1) | (cur[k+1] << 63),
+                         (d << 1) | (down[k-1] >> 63), d, (d >> 1) | (down[k+1] << 63));
+    }
+}
+
+#ifdef LIFE_X86_KERNELS
+
+/*
+  Each vector kernel is ruleWord() written with intrinsics.  The west and
+  east neighbors of a vector of words come from unaligned loads one word
+  to either side, so bits carry across word boundaries for free.  GCC's
+  vector types have the bitwise operators, so the same Rule::apply() is
+  used on words and vectors.
+*/
+
+__attribute__((target("sse2")))
+static inline __m128i fullSum128(__m128i a, __m128i b, __m128i c, __m128i &carry) {
+    __m128i ab = _mm_xor_si128(a, b);
+    carry = _mm_or_si128(_mm_and_si128(a, b), _mm_and_si128(c, ab));
+    return _mm_xor_si128(ab, c);
+}
+
+__attribute__((target("sse2")))
+static inline __m128i shifted128(const uint64_t *row, int k, __m128i &west, __m128i &east) {
+    __m128i x = _mm_loadu_si128((const __m128i *)(row+k));
+    __m128i prev = _mm_loadu_si128((const __m128i *)(row+k-1));
+    __m128i next = _mm_loadu_si128((const __m128i *)(row+k+1));
+    west = _mm_or_si128(_mm_slli_epi64(x, 1), _mm_srli_epi64(prev, 63));
+    east = _mm_or_si128(_mm_srli_epi64(x, 1), _mm_slli_epi64(next, 63));
+    return x;
+}
+
+template <class Rule>
+__attribute__((target("sse2")))
+static void sse2Row(const uint64_t *up, const uint64_t *cur,
+                    const uint64_t *down, uint64_t *out,
+                    int begin, int end, const LifeRule &rule) {
+    Rule r(rule);
+    int k = begin;
+    for (; k+2 <= end; k += 2) {
+        __m128i uw, ue, mw, me, dw, de;
+        __m128i u = shifted128(up, k, uw, ue);
+        __m128i m = shifted128(cur, k, mw, me);
+        __m128i d = shifted128(down, k, dw, de);
+
+        __m128i upCarry, downCarry, onesCarry, tCarry;
+        __m128i upSum = fullSum128(uw, u, ue, upCarry);
+        __m128i downSum = fullSum128(dw, d, de, downCarry);
+        __m128i midSum = _mm_xor_si128(mw, me);
+        __m128i midCarry = _mm_and_si128(mw, me);
+
+        __m128i ones = fullSum128(upSum, downSum, midSum, onesCarry);
+        __m128i t = fullSum128(upCarry, downCarry, midCarry, tCarry);
+        __m128i twos = _mm_xor_si128(t, onesCarry);
+        __m128i fours = _mm_xor_si128(tCarry, _mm_and_si128(t, onesCarry));
+
+        __m128i eights = _mm_and_si128(tCarry, _mm_and_si128(t, onesCarry));
+
+        __m128i result = r.apply(ones, twos, fours, eights, m);
+        _mm_storeu_si128((__m128i *)(out+k), result);
+    }
+    scalarRow<Rule>(up, cur, down, out, k, end, rule);
+}
+
+__attribute__((target("avx2")))
+static inline __m256i fullSum256(__m256i a, __m256i b, __m256i c, __m256i &carry) {
+    __m256i ab = _mm256_xor_si256(a, b);
+    carry = _mm256_or_si256(_mm256_and_si256(a, b), _mm256_and_si256(c, ab));
+    return _mm256_xor_si256(ab, c);
+}
+
+__attribute__((target("avx2")))
+static inline __m256i shifted256(const uint64_t *row, int k, __m256i &west, __m256i &east) {
+    __m256i x = _mm256_loadu_si256((const __m256i *)(row+k));
+    __m256i prev = _mm256_loadu_si256((const __m256i *)(row+k-1));
+    __m256i next = _mm256_loadu_si256((const __m256i *)(row+k+1));
+    west = _mm256_or_si256(_mm256_slli_epi64(x, 1), _mm256_srli_epi64(prev, 63));
+    east = _mm256_or_si256(_mm256_srli_epi64(x, 1), _mm256_slli_epi64(next, 63));
+    return x;
+}
+
+template <class Rule>
+__attribute__((target("avx2")))
+static void avx2Row(const uint64_t *up, const uint64_t *cur,
+                    const uint64_t *down, uint64_t *out,
+                    int begin, int end, const LifeRule &rule) {
+    Rule r(rule);
+    int k = begin;
+    for (; k+4 <= end; k += 4) {
+        __m256i uw, ue, mw, me, dw, de;
+        __m256i u = shifted256(up, k, uw, ue);
+        __m256i m = shifted256(cur, k, mw, me);
+        __m256i d = shifted256(down, k, dw, de);
+
+        __m256i upCarry, downCarry, onesCarry, tCarry;
+        __m256i upSum = fullSum256(uw, u, ue, upCarry);
+        __m256i downSum = fullSum256(dw, d, de, downCarry);
+        __m256i midSum = _mm256_xor_si256(mw, me);
+        __m256i midCarry = _mm256_and_si256(mw, me);
+
+        __m256i ones = fullSum256(upSum, downSum, midSum, onesCarry);
+        __m256i t = fullSum256(upCarry, downCarry, midCarry, tCarry);
+        __m256i twos = _mm256_xor_si256(t, onesCarry);
+        __m256i fours = _mm256_xor_si256(tCarry, _mm256_and_si256(t, onesCarry));
+
+        __m256i eights = _mm256_and_si256(tCarry, _mm256_and_si256(t, onesCarry));
+
+        __m256i result = r.apply(ones, twos, fours, eights, m);
+        _mm256_storeu_si256((__m256i *)(out+k), result);
+    }
+    sse2Row<Rule>(up, cur, down, out, k, end, rule);
+}
+
+__attribute__((target("avx512f")))
+static inline __m512i fullSum512(__m512i a, __m512i b, __m512i c, __m512i &carry) {
+    __m512i ab = _mm512_xor_si512(a, b);
+    carry = _mm512_or_si512(_mm512_and_si512(a, b), _mm512_and_si512(c, ab));
+    return _mm512_xor_si512(ab, c);
+}
+
+__attribute__((target("avx512f")))
+static inline __m512i shifted512(const uint64_t *row, int k, __m512i &west, __m512i &east) {
+    __m512i x = _mm512_loadu_si512((const void *)(row+k));
+    __m512i prev = _mm512_loadu_si512((const void *)(row+k-1));
+    __m512i next = _mm512_loadu_si512((const void *)(row+k+1));
+    // The zero-masked shifts, since the plain ones merge into an undefined
+    // vector that GCC warns may be uninitialized
+    const __mmask8 all = 0xff;
+    west = _mm512_or_si512(_mm512_maskz_slli_epi64(all, x, 1), _mm512_maskz_srli_epi64(all, prev, 63));
+    east = _mm512_or_si512(_mm512_maskz_srli_epi64(all, x, 1), _mm512_maskz_slli_epi64(all, next, 63));
+    return x;
+}
+
+template <class Rule>
+__attribute__((target("avx512f")))
+static void avx512Row(const uint64_t *up, const uint64_t *cur,
+                      const uint64_t *down, uint64_t *out,
+                      int begin, int end, const LifeRule &rule) {
+    Rule r(rule);
+    int k = begin;
+    for (; k+8 <= end; k += 8) {
+        __m512i uw, ue, mw, me, dw, de;
+        __m512i u = shifted512(up, k, uw, ue);
+        __m512i m = shifted512(cur, k, mw, me);
+        __m512i d = shifted512(down, k, dw, de);
+
+        __m512i upCarry, downCarry, onesCarry, tCarry;
+        __m512i upSum = fullSum512(uw, u, ue, upCarry);
+        __m512i downSum = fullSum512(dw, d, de, downCarry);
+        __m512i midSum = _mm512_xor_si512(mw, me);
+        __m512i midCarry = _mm512_and_si512(mw, me);
+
+        __m512i ones = fullSum512(upSum, downSum, midSum, onesCarry);
+        __m512i t = fullSum512(upCarry, downCarry, midCarry, tCarry);
+        __m512i twos = _mm512_xor_si512(t, onesCarry);
+        __m512i fours = _mm512_xor_si512(tCarry, _mm512_and_si512(t, onesCarry));
+
+        __m512i eights = _mm512_and_si512(tCarry, _mm512_and_si512(t, onesCarry));
+
+        __m512i result = r.apply(ones, twos, fours, eights, m);
+        _mm512_storeu_si512((void *)(out+k), result);
+    }
+    scalarRow<Rule>(up, cur, down, out, k, end, rule);
+}
+
+#endif
+
+#define RULE_KERNELS(row) \
+    { row<ConwayRule>, row<HighLifeRule>, row<DayAndNightRule>, row<SeedsRule>, row<MaskRule> }
+
+static RowKernelInfo detectRowKernel() {
+    RowKernelInfo info = scalarRowKernel();
+#ifdef LIFE_X86_KERNELS
+    static const RowKernelInfo sse2 = { "SSE2", RULE_KERNELS(sse2Row) };
+    static const RowKernelInfo avx2 = { "AVX2", RULE_KERNELS(avx2Row) };
+    static const RowKernelInfo avx512 = { "AVX-512", RULE_KERNELS(avx512Row) };
+
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx512f")) {
+        info = avx512;
+    } else if (__builtin_cpu_supports("avx2")) {
+        info = avx2;
+    } else if (__builtin_cpu_supports("sse2")) {
+        info = sse2;
+    }
+#endif
+    return info;
+}
+
+const RowKernelInfo &scalarRowKernel() {
+    static const RowKernelInfo info = { "Scalar", RULE_KERNELS(scalarRow) };
+    return info;
+}
+
+const RowKernelInfo &bestRowKernel() {
+    static const RowKernelInfo info = detectRowKernel();
+    return info;
+}
@@ -0,0 +1,48 @@
+/*
+  lifekernels.h
+
+  Copyright (c) 2011, Jeremiah LaRocco jeremiah.larocco@gmail.com
+
+  Permission to use, copy, modify, and/or distribute this software for any
+  purpose with or without fee is hereby granted, provided that the above
+  copyright notice and this permission notice appear in all copies.
+
+  THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+  WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+  MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+  ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+  WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+  ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+  OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+
+#ifndef LIFE_KERNELS_INCLUDE_H
+#define LIFE_KERNELS_INCLUDE_H
+
+#include <stdint.h>
+
+#include "liferule.h"
+
+/*
+  Evolves words [begin, end) of one packed row.  up, cur and down point at
+  the start of the rows above, at and below the one being computed, and
+  every word in the range must have a neighbor word on both sides, so the
+  first and last word of a row are left to the caller.  Only the generic
+  kernels look at rule, the others have it compiled in.
+*/
+typedef void (*RowKernel)(const uint64_t *up, const uint64_t *cur,
+                          const uint64_t *down, uint64_t *out,
+                          int begin, int end, const LifeRule &rule);
+
+struct RowKernelInfo {
+    const char *name;
+    // Indexed by LifeRule::Kind
+    RowKernel kernels[LifeRule::NumKinds];
+};
+
+// Widest kernel the CPU supports, detected with cpuid on first use
+const RowKernelInfo &bestRowKernel();
+
+const RowKernelInfo &scalarRowKernel();
+
+#endif
@@ -0,0 +1,70 @@
+/*
+  lifetable.cpp
+
+  Copyright (c) 2011, Jeremiah LaRocco jeremiah.larocco@gmail.com
+
+  Permission to use, copy, modify, and/or distribute this software for any
+  purpose with or without fee is hereby granted, provided that the above
+  copyright notice and this permission notice appear in all copies.
+
+  THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+  WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+  MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+  ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+  WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+  ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+  OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+
+#include "lifetable.h"
+
+void fillLifeTable(uint8_t *table, const LifeRule &rule) {
+    for (int idx=0; idx<65536; ++idx) {
+        uint8_t result = 0;
+        for (int y=1; y<3; ++y) {
+            for (int x=1; x<3; ++x) {
+                int num = 0;
+                for (int dy=-1; dy<=1; ++dy) {
+                    for (int dx=-1; dx<=1; ++dx) {
+                        if (dx || dy) {
+                            num += (idx >> ((y+dy)*4 + x+dx)) & 1;
+                        }
+                    }
+                }
+                bool alive = (idx >> (y*4 + x)) & 1;
+                if (rule.next(alive, num)) {
+                    result |= 1 << ((y-1)*2 + x-1);
+                }
+            }
+        }
+        table[idx] = result;
+    }
+}
+
+// Four cells of a padded row starting at bit 2*j of word k
+static inline unsigned int nibble(const uint64_t *row, int k, int j) {
+    if (j < 31) {
+        return unsigned(row[k] >> (2*j)) & 0xF;
+    }
+    return unsigned((row[k] >> 62) | (row[k+1] << 2)) & 0xF;
+}
+
+void tableRowPair(const uint8_t *table,
+                  const uint64_t *r0, const uint64_t *r1,
+                  const uint64_t *r2, const uint64_t *r3,
+                  uint64_t *out0, uint64_t *out1, int words) {
+    for (int k=0; k<words; ++k) {
+        uint64_t upper = 0, lower = 0;
+        for (int j=0; j<32; ++j) {
+            unsigned int idx = nibble(r0, k, j) | (nibble(r1, k, j) << 4) |
+                (nibble(r2, k, j) << 8) | (nibble(r3, k, j) << 12);
+            uint64_t next = table[idx];
+            upper |= (next & 3) << (2*j);
+            lower |= (next >> 2) << (2*j);
+        }
+        out0[k] = upper;
+        if (out1) {
+            out1[k] = lower;
+        }
+    }
+}
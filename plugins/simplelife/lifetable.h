@@ -0,0 +1,46 @@
+/*
+  lifetable.h
+
+  Copyright (c) 2011, Jeremiah LaRocco jeremiah.larocco@gmail.com
+
+  Permission to use, copy, modify, and/or distribute this software for any
+  purpose with or without fee is hereby granted, provided that the above
+  copyright notice and this permission notice appear in all copies.
+
+  THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+  WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+  MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+  ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+  WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+  ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+  OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+
+#ifndef LIFE_TABLE_INCLUDE_H
+#define LIFE_TABLE_INCLUDE_H
+
+#include <stdint.h>
+
+#include "liferule.h"
+
+/*
+  Fills a 65536 entry table for rule.  The index is a 4x4 block of cells, four
+  bits per row with row 0 in the low nibble and the westmost cell in the
+  low bit of each nibble.  The entry is the next state of the center 2x2:
+  bits 0 and 1 for the upper row, bits 2 and 3 for the lower one.
+*/
+void fillLifeTable(uint8_t *table, const LifeRule &rule);
+
+/*
+  Evolves two rows with the table.  r0 to r3 are padded copies of the row
+  above, the two rows being computed and the row below: bit i of a padded
+  row holds column i-1, and each has words+1 words so the pair of columns
+  in the last word can see its east neighbors.  out1 may be 0 when only
+  the first row is wanted.
+*/
+void tableRowPair(const uint8_t *table,
+                  const uint64_t *r0, const uint64_t *r1,
+                  const uint64_t *r2, const uint64_t *r3,
+                  uint64_t *out0, uint64_t *out1, int words);
+
+#endif
@@ -22,19 +22,27 @@
 #include <QSettings>
 
 #include <cstdlib>
+#include <algorithm>
+#include <cmath>
 
 #include "simplelife.h"
 
-#include "simplelifeconfig.h"
+#include "lifeparallel.h"
 
-size_t randUInt(size_t min, size_t max) {
-    return ((std::rand()%(max-min)) + min);
-}
+#include "simplelifeconfig.h"
 
-SimpleLife::SimpleLife() : width(128), height(128), prob(0.4), r(0),g(1),b(1) {
+SimpleLife::SimpleLife() : engine(BitBoardEngine), allocations(0), width(128), height(128), prob(0.4), r(0),g(1),b(1),
+                           maxPeriod(32), generation(0),
+                           viewWidth(1), viewHeight(1), viewZoom(1), viewX(0), viewY(0),
+                           level(0), regionCol(0), regionRow(0), regionWidth(0), regionHeight(0),
+                           texWidth(0), texHeight(0), texCols(0), texRows(0), texturesStale(true),
+                           seed(0), boardSeed(0), fillBits(0), settings(0) {
+    board.setKernel(bestRowKernel());
 }
 
 void SimpleLife::readSettings(QSettings *sets) {
+    settings = sets;
+
     width = sets->value("simple_width", 128).toInt();
     height = sets->value("simple_height", 128).toInt();
 
@@ -44,6 +52,15 @@ void SimpleLife::readSettings(QSettings *sets) {
     g = sets->value("simple_green", 0.8).toFloat();
     b = sets->value("simple_blue", 0.4).toFloat();
 
+    engine = Engine(sets->value("simple_engine", BitBoardEngine).toInt());
+    maxPeriod = sets->value("simple_max_period", 32).toInt();
+    seed = sets->value("simple_seed", 0).toULongLong();
+
+    LifeRule newRule;
+    if (newRule.parse(sets->value("simple_rule", "B3/S23").toString().toLatin1().constData())) {
+        setRule(newRule);
+    }
+
     reset();
 }
 
@@ -54,6 +71,7 @@ void SimpleLife::configure(QWidget *parent, QSettings *sets) {
 
 SimpleLife::~SimpleLife() {
     array.clear();
+    board.resize(0, 0);
 }
 
 QString SimpleLife::name() {
@@ -64,8 +82,47 @@ QString SimpleLife::description() {
     return tr("Traditional Conway's game of life.");
 }
 
+QString SimpleLife::engineInfo() {
+    if (engine == BitBoardEngine) {
+        return tr("Bitboard (%1), %2, %3/%4 tiles active")
+            .arg(board.kernelName())
+            .arg(QString::fromLatin1(rule.toString().c_str()))
+            .arg(board.activeTiles())
+            .arg(board.tileCount()) + runInfo();
+    }
+    if (engine == TableEngine) {
+        return tr("Lookup table, %1").arg(QString::fromLatin1(rule.toString().c_str())) + runInfo();
+    }
+    return tr("Classic, %1").arg(QString::fromLatin1(rule.toString().c_str())) + runInfo();
+}
+
+// Seed and cycle detection, appended to engineInfo()
+QString SimpleLife::runInfo() {
+    QString info = tr(", seed %1").arg(boardSeed);
+    if (!history.found()) {
+        return info;
+    }
+    if (history.period() == 1) {
+        return info + tr(", still life since generation %1").arg(qulonglong(history.foundAt()));
+    }
+    return info + tr(", period %1 since generation %2")
+        .arg(history.period())
+        .arg(qulonglong(history.foundAt()));
+}
+
+double SimpleLife::population() {
+    if (engine != ClassicEngine) {
+        return double(board.population());
+    }
+    double total = 0;
+    for (int i=0; i<height; ++i) {
+        total += std::count(array[i].begin(), array[i].end(), true);
+    }
+    return total;
+}
+
 bool SimpleLife::allowViewManipulation() {
-    return false;
+    return true;
 }
 
 void SimpleLife::initView() {
@@ -74,107 +131,418 @@ void SimpleLife::initView() {
     glDisable(GL_LIGHTING);
     
     glDisable(GL_LIGHT0);
+
+    viewZoom = 1;
+    viewX = 0.5*width;
+    viewY = 0.5*height;
 }
 
 void SimpleLife::resizeView(int width, int height) {
-    glViewport(0,0, (GLsizei) width, (GLsizei)height);
-    glMatrixMode(GL_PROJECTION);
-    glLoadIdentity();
-    gluOrtho2D(0, 100,
-               0, 100);
+    viewWidth = width > 0 ? width : 1;
+    viewHeight = height > 0 ? height : 1;
 
+    glViewport(0,0, (GLsizei) width, (GLsizei)height);
     glMatrixMode(GL_MODELVIEW);
 
     glClear(GL_COLOR_BUFFER_BIT);
 }
 
+// Wheel steps are about 4, two of them double or halve the zoom
+void SimpleLife::zoom(double amt) {
+    viewZoom *= std::pow(2.0, -amt/7.5);
+    viewZoom = qBound(1.0, viewZoom, qMax(1.0, qMin(width, height)/8.0));
+}
+
+// Drags the board along with the mouse; dx and dy are fractions of the widget
+void SimpleLife::pan(double dx, double dy) {
+    viewX -= dx*width/viewZoom;
+    viewY += dy*height/viewZoom;
+}
+
+// Part of the board in view, in cells, kept inside the board
+void SimpleLife::visibleRect(double &left, double &bottom, double &visWidth, double &visHeight) {
+    visWidth = width/viewZoom;
+    visHeight = height/viewZoom;
+    viewX = qBound(0.5*visWidth, viewX, width - 0.5*visWidth);
+    viewY = qBound(0.5*visHeight, viewY, height - 0.5*visHeight);
+    left = viewX - 0.5*visWidth;
+    bottom = viewY - 0.5*visHeight;
+}
+
 bool SimpleLife::evolve() {
     // qDebug() << "Evolving";
 
-    int h = height;
-    int w = width;
+    if (engine == TableEngine) {
+        board.evolveTable();
+    } else if (engine == BitBoardEngine) {
+        board.evolve();
+    } else {
+        // Both buffers are sized in reset(), evolving only swaps them
+        Q_ASSERT(int(nextArray.size()) == height);
 
-    std::vector< std::vector<bool> > rval;
-    
+        // Each band writes whole rows of nextArray, so bands never share a word
+        parallelBands(height, this, &SimpleLife::evolveRows, 16384/qMax(width, 1) + 1);
+
+        array.swap(nextArray);
+    }
+    ++generation;
+
+    // Only the bitboard knows which rows changed
+    for (size_t band=0; band<dirtyBands.size(); ++band) {
+        if (engine != BitBoardEngine || board.tileRowChanged(int(band))) {
+            dirtyBands[band] = 1;
+        }
+    }
+
+    // Stop once the board repeats, the first time only so a restarted run
+    // keeps going
+    return history.enabled() && history.record(boardHash(), generation);
+}
+
+uint64_t SimpleLife::boardHash() {
+    if (engine != ClassicEngine) {
+        return board.hash();
+    }
+    parallelBands(height, this, &SimpleLife::hashRows, 16384/qMax(width, 1) + 1);
+    uint64_t total = 0;
     for (int i=0; i<height; ++i) {
-        rval.push_back(std::vector<bool>());
-        rval[i].resize(width, false);
+        total ^= rowHashes[i];
     }
+    return total;
+}
+
+void SimpleLife::hashRows(int begin, int end) {
+    for (int i=begin; i<end; ++i) {
+        uint64_t sum = lifeMix64(i + 1);
+        for (int j=0; j<width; j+=64) {
+            uint64_t word = 0;
+            int bits = qMin(64, width-j);
+            for (int n=0; n<bits; ++n) {
+                word |= uint64_t(array[i][j+n]) << n;
+            }
+            sum = sum*0x9e3779b97f4a7c15ULL + word;
+        }
+        rowHashes[i] = lifeMix64(sum);
+    }
+}
 
-    for (int i=0; i<h; ++i) {
+// Picks the evolve loop compiled for the current rule
+void SimpleLife::evolveRows(int begin, int end) {
+    switch (rule.kind()) {
+    case LifeRule::Conway:
+        evolveRuleRows<ConwayRule>(begin, end);
+        break;
+    case LifeRule::HighLife:
+        evolveRuleRows<HighLifeRule>(begin, end);
+        break;
+    case LifeRule::DayAndNight:
+        evolveRuleRows<DayAndNightRule>(begin, end);
+        break;
+    case LifeRule::Seeds:
+        evolveRuleRows<SeedsRule>(begin, end);
+        break;
+    default:
+        evolveRuleRows<MaskRule>(begin, end);
+        break;
+    }
+}
+
+template <class Rule>
+void SimpleLife::evolveRuleRows(int begin, int end) {
+    Rule r(rule);
+    int w = width;
+
+    for (int i=begin; i<end; ++i) {
         for (int j=0; j<w; ++j) {
             int num = countNeighbors(i,j);
-
-            if (array[i][j]) {
-                if ((num < 2) || (num > 3)) {
-                    rval[i][j] = false;
-                } else {
-                    rval[i][j] = true;
-                }
-            } else {
-                if (num == 3) {
-                    rval[i][j] = true;
-                } else {
-                    rval[i][j] = false;
-                }
-            }
+            nextArray[i][j] = r.next(array[i][j], num);
         }
     }
-    array = rval;
-    return false;
 }
 
 void SimpleLife::draw() {
     glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
     glPolygonMode(GL_FRONT_AND_BACK, GL_FILL);
-    // glTranslatef(-0.5*width, -0.5*height, 0);
-    float dx = 100.0/width;
-    float dy = 100.0/height;
-
-    // qDebug() << "Drawing";
-    for (int i=0; i < height; ++i) {
-        float cy = i*dy;
-        for (int j=0; j<width; ++j) {
-            
-            if (array[i][j]) {
-                float cx = j*dx;
-                
-                glBegin(GL_QUADS);
-                glColor3f(r,g,b);
-                glVertex2f(cx, cy);
-                glVertex2f(cx+dx, cy);
-                glVertex2f(cx+dx, cy+dy);
-                glVertex2f(cx, cy+dy);
-                glEnd();
-            }
+
+    updateRegion();
+    shadeDirtyRows();
+    uploadDirtyRows();
+
+    // Coordinates are in cells from the corner of the region so deep zooms
+    // into big boards don't lose precision
+    double left, bottom, visWidth, visHeight;
+    visibleRect(left, bottom, visWidth, visHeight);
+    double x0 = double(regionCol) * (1 << level);
+    double y0 = double(regionRow) * (1 << level);
+    glMatrixMode(GL_PROJECTION);
+    glLoadIdentity();
+    gluOrtho2D(left - x0, left + visWidth - x0,
+               bottom - y0, bottom + visHeight - y0);
+    glMatrixMode(GL_MODELVIEW);
+
+    // Texels are the fraction of live cells, so modulating gives the cell
+    // color on black, dimmer where the board is sparse
+    glEnable(GL_TEXTURE_2D);
+    glTexEnvi(GL_TEXTURE_ENV, GL_TEXTURE_ENV_MODE, GL_MODULATE);
+    glColor3f(r,g,b);
+
+    // A texel covers a whole block even where the last block is cut short
+    // by the edge of the board; that part is outside the view
+    for (int tr=0; tr<texRows; ++tr) {
+        int row0 = tr*texHeight;
+        int row1 = qMin(regionHeight, row0 + texHeight);
+        for (int tc=0; tc<texCols; ++tc) {
+            int col0 = tc*texWidth;
+            int col1 = qMin(regionWidth, col0 + texWidth);
+            float s = float(col1 - col0)/texWidth;
+            float t = float(row1 - row0)/texHeight;
+            float qx0 = float(col0 << level);
+            float qx1 = float(col1 << level);
+            float qy0 = float(row0 << level);
+            float qy1 = float(row1 << level);
+
+            glBindTexture(GL_TEXTURE_2D, textures[tr*texCols + tc]);
+            glBegin(GL_QUADS);
+            glTexCoord2f(0, 0);
+            glVertex2f(qx0, qy0);
+            glTexCoord2f(s, 0);
+            glVertex2f(qx1, qy0);
+            glTexCoord2f(s, t);
+            glVertex2f(qx1, qy1);
+            glTexCoord2f(0, t);
+            glVertex2f(qx0, qy1);
+            glEnd();
         }
     }
+
+    glDisable(GL_TEXTURE_2D);
     glFlush();
 }
 
+/*
+  Picks the smallest level whose blocks are no smaller than a pixel for
+  the cells in view, and the blocks covering them.  Texels are only kept
+  for those blocks, so drawing a small part of a huge board costs about as
+  much as drawing a small board.
+*/
+void SimpleLife::updateRegion() {
+    double left, bottom, visWidth, visHeight;
+    visibleRect(left, bottom, visWidth, visHeight);
+
+    int col0 = int(left);
+    int row0 = int(bottom);
+    int col1 = qMin(width, int(std::ceil(left + visWidth)));
+    int row1 = qMin(height, int(std::ceil(bottom + visHeight)));
+
+    int lev = 0;
+    while (((col1 - col0 - 1) >> lev) + 1 > viewWidth ||
+           ((row1 - row0 - 1) >> lev) + 1 > viewHeight) {
+        ++lev;
+    }
+
+    int newCol = col0 >> lev;
+    int newRow = row0 >> lev;
+    int newWidth = ((col1 - 1) >> lev) + 1 - newCol;
+    int newHeight = ((row1 - 1) >> lev) + 1 - newRow;
+
+    if (texturesStale || lev != level || newWidth != regionWidth || newHeight != regionHeight) {
+        level = lev;
+        regionCol = newCol;
+        regionRow = newRow;
+        regionWidth = newWidth;
+        regionHeight = newHeight;
+        createTextures();
+    } else if (newCol != regionCol || newRow != regionRow) {
+        // Panned the same size region, every texel moves
+        regionCol = newCol;
+        regionRow = newRow;
+        std::fill(dirtyRows.begin(), dirtyRows.end(), 1);
+    }
+}
+
+// Power of two sizes, so this works without NPOT texture support
+static int textureSize(int cells, int maxSize) {
+    int size = 64;
+    while (size < cells && size < maxSize) {
+        size *= 2;
+    }
+    return size;
+}
+
+void SimpleLife::createTextures() {
+    if (!textures.empty()) {
+        glDeleteTextures(GLsizei(textures.size()), &textures[0]);
+    }
+
+    texels.assign(regionWidth*regionHeight, 0);
+    dirtyRows.assign(regionHeight, 1);
+
+    texWidth = textureSize(regionWidth, MAX_TEXTURE_SIZE);
+    texHeight = textureSize(regionHeight, MAX_TEXTURE_SIZE);
+    texCols = (regionWidth + texWidth - 1)/texWidth;
+    texRows = (regionHeight + texHeight - 1)/texHeight;
+
+    textures.assign(texCols*texRows, 0);
+    glGenTextures(GLsizei(textures.size()), &textures[0]);
+    for (size_t t=0; t<textures.size(); ++t) {
+        glBindTexture(GL_TEXTURE_2D, textures[t]);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP);
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_LUMINANCE8, texWidth, texHeight, 0,
+                     GL_LUMINANCE, GL_UNSIGNED_BYTE, 0);
+    }
+
+    texturesStale = false;
+}
+
+// Turns the dirty bands of cells into dirty texel rows in view, then shades them
+void SimpleLife::shadeDirtyRows() {
+    const int bandRows = BitBoard::TILE_ROWS;
+    for (size_t band=0; band<dirtyBands.size(); ++band) {
+        if (!dirtyBands[band]) {
+            continue;
+        }
+        dirtyBands[band] = 0;
+        int first = qMax(regionRow, (int(band)*bandRows) >> level);
+        int last = qMin(regionRow + regionHeight - 1,
+                        (qMin(height, int(band+1)*bandRows) - 1) >> level);
+        for (int y=first; y<=last; ++y) {
+            dirtyRows[y - regionRow] = 1;
+        }
+    }
+
+    // Each texel row reads 2^level rows of cells, a lot of memory when
+    // zoomed far out, so rows are shaded in parallel
+    parallelBands(regionHeight, this, &SimpleLife::shadeRows, 16384/qMax(regionWidth, 1) + 1);
+}
+
+void SimpleLife::shadeRows(int begin, int end) {
+    std::vector<uint32_t> counts(regionWidth);
+    int size = 1 << level;
+
+    for (int y=begin; y<end; ++y) {
+        if (!dirtyRows[y]) {
+            continue;
+        }
+        int blockRow = regionRow + y;
+
+        if (engine != ClassicEngine) {
+            board.blockCounts(level, blockRow, regionCol, regionWidth, &counts[0]);
+        } else {
+            std::fill(counts.begin(), counts.end(), 0);
+            int colEnd = qMin(width, (regionCol + regionWidth)*size);
+            for (int i=blockRow*size; i<qMin(height, (blockRow+1)*size); ++i) {
+                for (int j=regionCol*size; j<colEnd; ++j) {
+                    counts[(j >> level) - regionCol] += array[i][j];
+                }
+            }
+        }
+
+        // Blocks on the right and bottom edges of the board can be cut short
+        unsigned char *out = &texels[y*regionWidth];
+        int blockRows = qMin(height, (blockRow+1)*size) - blockRow*size;
+        for (int x=0; x<regionWidth; ++x) {
+            int blockCol = regionCol + x;
+            int blockCols = qMin(width, (blockCol+1)*size) - blockCol*size;
+            out[x] = (unsigned char)((uint64_t(counts[x])*255)/(uint64_t(blockRows)*blockCols));
+        }
+    }
+}
+
+void SimpleLife::uploadDirtyRows() {
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    glPixelStorei(GL_UNPACK_ROW_LENGTH, regionWidth);
+
+    int y = 0;
+    while (y < regionHeight) {
+        if (!dirtyRows[y]) {
+            ++y;
+            continue;
+        }
+        // Upload runs of dirty rows, split where the texture row ends
+        int tr = y/texHeight;
+        int runEnd = y+1;
+        while (runEnd < qMin(regionHeight, (tr+1)*texHeight) && dirtyRows[runEnd]) {
+            ++runEnd;
+        }
+        for (int tc=0; tc<texCols; ++tc) {
+            int col0 = tc*texWidth;
+            glBindTexture(GL_TEXTURE_2D, textures[tr*texCols + tc]);
+            glTexSubImage2D(GL_TEXTURE_2D, 0, 0, y - tr*texHeight,
+                            qMin(regionWidth - col0, texWidth), runEnd - y,
+                            GL_LUMINANCE, GL_UNSIGNED_BYTE, &texels[y*regionWidth + col0]);
+        }
+        std::fill(dirtyRows.begin() + y, dirtyRows.begin() + runEnd, 0);
+        y = runEnd;
+    }
+
+    glPixelStorei(GL_UNPACK_ROW_LENGTH, 0);
+}
+
 void SimpleLife::reset() {
     array.clear();
-    for (int i=0; i<height; ++i) {
-        array.push_back(std::vector<bool>());
-        array[i].resize(width, false);
+    nextArray.clear();
+    board.resize(0, 0);
+    if (engine != ClassicEngine) {
+        board.resize(width, height);
+    } else {
+        array.resize(height, std::vector<bool>(width, false));
+        nextArray.resize(height, std::vector<bool>(width, false));
+        allocations += 2;
     }
-    int num = prob*width*height;
-    for (int i=0;i<num; ++i) {
-        size_t ri = randUInt(0, height);
-        size_t rj = randUInt(0, width);
-        array[ri][rj] = true;
+
+    boardSeed = seed ? seed : lifeNewSeed();
+    if (settings) {
+        settings->setValue("simple_last_seed", boardSeed);
+    }
+
+    // Both engines number the words the same way, so a seed gives the same
+    // board whichever engine is used
+    LifeBernoulli bits(boardSeed, prob);
+    if (engine != ClassicEngine) {
+        board.fillRandom(bits);
+    } else {
+        fillBits = &bits;
+        parallelBands(height, this, &SimpleLife::fillRows, 16384/qMax(width, 1) + 1);
+        fillBits = 0;
+    }
+
+    // Board size or engine may have changed, so start the textures over
+    texturesStale = true;
+    dirtyBands.assign((height + BitBoard::TILE_ROWS - 1)/BitBoard::TILE_ROWS, 1);
+
+    generation = 0;
+    rowHashes.assign(engine == ClassicEngine ? height : 0, 0);
+    history.reset(maxPeriod);
+    if (history.enabled()) {
+        history.record(boardHash(), 0);
     }
-    
 }
+
+void SimpleLife::fillRows(int begin, int end) {
+    int words = (width+63)/64;
+    for (int i=begin; i<end; ++i) {
+        for (int k=0; k<words; ++k) {
+            uint64_t word = fillBits->word(uint64_t(i)*words + k);
+            int bits = qMin(64, width - 64*k);
+            for (int n=0; n<bits; ++n) {
+                array[i][64*k + n] = (word >> n) & 1;
+            }
+        }
+    }
+}
+
 int SimpleLife::countNeighbors(int i, int j) {
     int w = width;
     int h = height;
 
     int num = 0;
-    int up = i-1>0 ? i-1 : h-1;
-    int down = i+1 <h-1 ? i+1 : 0;
-    int left = j-1>0 ? j-1 : w-1;
-    int right = j+1 < w-1 ? j+1 : 0;
+    int up = i>0 ? i-1 : h-1;
+    int down = i+1<h ? i+1 : 0;
+    int left = j>0 ? j-1 : w-1;
+    int right = j+1<w ? j+1 : 0;
     
     num += array[up][j];
     num += array[down][j];
@@ -217,5 +585,38 @@ void SimpleLife::getDim(int &w, int &h) {
     h = height;
 }
 
+int SimpleLife::bufferAllocations() {
+    return allocations + board.allocations();
+}
+
+void SimpleLife::setEngine(Engine eng) {
+    engine = eng;
+}
+void SimpleLife::getEngine(Engine &eng) {
+    eng = engine;
+}
+
+void SimpleLife::setRule(const LifeRule &newRule) {
+    rule = newRule;
+    board.setRule(newRule);
+}
+void SimpleLife::getRule(LifeRule &curRule) {
+    curRule = rule;
+}
+
+void SimpleLife::setMaxPeriod(int period) {
+    maxPeriod = period;
+}
+void SimpleLife::getMaxPeriod(int &period) {
+    period = maxPeriod;
+}
+
+void SimpleLife::setSeed(quint64 newSeed) {
+    seed = newSeed;
+}
+void SimpleLife::getSeed(quint64 &curSeed) {
+    curSeed = seed;
+}
+
 
 Q_EXPORT_PLUGIN2(simplelife, SimpleLife)
@@ -32,11 +32,22 @@
 
 #include "lifeplugin.h"
 
+#include "lifehistory.h"
+
+#include "bitboard.h"
+
 class SimpleLife : public QObject, public LifePlugin {
     Q_OBJECT;
     Q_INTERFACES(LifePlugin);
   
 public:
+    enum Engine {
+        ClassicEngine = 0,
+        BitBoardEngine = 1,
+        // Bitboard cells, evolved 2x2 at a time from a 4x4 lookup table
+        TableEngine = 2
+    };
+
     SimpleLife();
     ~SimpleLife();
 
@@ -53,6 +64,14 @@ public:
     virtual void readSettings(QSettings *sets);
     virtual void configure(QWidget *parent, QSettings *sets);
 
+    virtual void zoom(double amt);
+    virtual void pan(double dx, double dy);
+
+    virtual QString engineInfo();
+    virtual double population();
+    // Only reset() and the first lookup table generation allocate
+    virtual int bufferAllocations();
+
     void setRGB(double red, double green, double blue);
     void getRGB(double &red, double &green, double &blue);
 
@@ -61,15 +80,87 @@ public:
 
     void setDim(int w, int h);
     void getDim(int &w, int &h);
+
+    void setEngine(Engine eng);
+    void getEngine(Engine &eng);
+
+    void setRule(const LifeRule &newRule);
+    void getRule(LifeRule &curRule);
+
+    // evolve() returns true once the board repeats within this many
+    // generations, 0 never stops
+    void setMaxPeriod(int period);
+    void getMaxPeriod(int &period);
+
+    // Boards are filled from this seed, or a new one each reset() if 0
+    void setSeed(quint64 newSeed);
+    void getSeed(quint64 &curSeed);
     
 private:
     int countNeighbors(int i, int j);
+    void evolveRows(int begin, int end);
+    template <class Rule>
+    void evolveRuleRows(int begin, int end);
+
+    void visibleRect(double &left, double &bottom, double &visWidth, double &visHeight);
+    void updateRegion();
+    void createTextures();
+    void shadeDirtyRows();
+    void shadeRows(int begin, int end);
+    void uploadDirtyRows();
+
+    void fillRows(int begin, int end);
+
+    uint64_t boardHash();
+    void hashRows(int begin, int end);
+    QString runInfo();
 
 private:
+    Engine engine;
+    LifeRule rule;
     std::vector< std::vector<bool> > array;
+    std::vector< std::vector<bool> > nextArray;
+    int allocations;
+    BitBoard board;
     int width, height;
     double prob;
     double r,g,b;
+
+    int maxPeriod;
+    uint64_t generation;
+    LifeHistory history;
+    std::vector<uint64_t> rowHashes;
+
+    // Widget size in pixels, and the part of the board in view: viewZoom
+    // times closer than the whole board, centered on cell (viewX, viewY)
+    int viewWidth, viewHeight;
+    double viewZoom;
+    double viewX, viewY;
+
+    // The part of the board in view is drawn at a level of detail where
+    // each texel is the density of a 2^level square block of cells, coarse
+    // enough that the texels fit in the widget.  The blocks in view start
+    // at block (regionCol, regionRow), and their texels live in a grid of
+    // luminance textures of at most MAX_TEXTURE_SIZE square.  Only rows
+    // under bands of BitBoard::TILE_ROWS cell rows that changed are shaded
+    // and uploaded again.
+    static const int MAX_TEXTURE_SIZE = 1024;
+    int level;
+    int regionCol, regionRow;
+    int regionWidth, regionHeight;
+    std::vector<GLuint> textures;
+    int texWidth, texHeight;
+    int texCols, texRows;
+    bool texturesStale;
+    std::vector<unsigned char> dirtyBands;
+    std::vector<unsigned char> dirtyRows;
+    std::vector<unsigned char> texels;
+
+    quint64 seed;
+    // Seed of the current board, saved as simple_last_seed
+    quint64 boardSeed;
+    const LifeBernoulli *fillBits;
+    QSettings *settings;
 };
 
 #endif
@@ -66,9 +66,47 @@ SimpleLifeConfig::SimpleLifeConfig(SimpleLife *sl,
     blueEdit = new QLineEdit(tr("%1").arg(b,0,'g', 3));
     layout->addWidget(blueEdit, curRow, 1);
     curRow += 1;
+
+    SimpleLife::Engine engine;
+    life->getEngine(engine);
+    layout->addWidget(new QLabel(tr("Engine")), curRow, 0);
+    engineCombo = new QComboBox;
+    engineCombo->addItem(tr("Classic"), SimpleLife::ClassicEngine);
+    engineCombo->addItem(tr("Bitboard"), SimpleLife::BitBoardEngine);
+    engineCombo->addItem(tr("Lookup table"), SimpleLife::TableEngine);
+    engineCombo->setCurrentIndex(engineCombo->findData(engine));
+    layout->addWidget(engineCombo, curRow, 1);
+    curRow += 1;
+
+    LifeRule rule;
+    life->getRule(rule);
+    layout->addWidget(new QLabel(tr("Rule")), curRow, 0);
+    ruleCombo = new QComboBox;
+    ruleCombo->setEditable(true);
+    ruleCombo->addItem("B3/S23");
+    ruleCombo->addItem("B36/S23");
+    ruleCombo->addItem("B3678/S34678");
+    ruleCombo->addItem("B2/S");
+    ruleCombo->setEditText(QString::fromLatin1(rule.toString().c_str()));
+    layout->addWidget(ruleCombo, curRow, 1);
+    curRow += 1;
+
+    int maxPeriod;
+    life->getMaxPeriod(maxPeriod);
+    layout->addWidget(new QLabel(tr("Max period")), curRow, 0);
+    periodEdit = new QLineEdit(tr("%1").arg(maxPeriod));
+    layout->addWidget(periodEdit, curRow, 1);
+    curRow += 1;
     // QPushButton *colorPicker = new QPushButton("");
     // colorPicker->
         
+    quint64 seed;
+    life->getSeed(seed);
+    layout->addWidget(new QLabel(tr("Seed (0 for a new one each reset)")), curRow, 0);
+    seedEdit = new QLineEdit(tr("%1").arg(seed));
+    layout->addWidget(seedEdit, curRow, 1);
+    curRow += 1;
+
     okayButton = new QPushButton(tr("Okay"));
     layout->addWidget(okayButton, curRow, 0);
     connect(okayButton, SIGNAL(clicked()), this, SLOT(finish()));
@@ -84,20 +122,40 @@ SimpleLifeConfig::SimpleLifeConfig(SimpleLife *sl,
 void SimpleLifeConfig::finish() {
     int newWidth = widthEdit->text().toInt();
     int newHeight = heightEdit->text().toInt();
+    if (newWidth < 1 || newHeight < 1) {
+        QMessageBox::warning(this, tr("Simple Life"),
+                             tr("The board has to be at least 1x1."));
+        return;
+    }
 
     double newProb = probEdit->text().toDouble();
     double newRed = redEdit->text().toDouble();
     double newGreen = greenEdit->text().toDouble();
     double newBlue = blueEdit->text().toDouble();
+    quint64 newSeed = seedEdit->text().toULongLong();
+
+    SimpleLife::Engine newEngine = SimpleLife::Engine(engineCombo->itemData(engineCombo->currentIndex()).toInt());
+    int newMaxPeriod = periodEdit->text().toInt();
+
+    LifeRule newRule;
+    if (!newRule.parse(ruleCombo->currentText().toLatin1().constData())) {
+        QMessageBox::warning(this, tr("Simple Life"),
+                             tr("\"%1\" is not a rule like B3/S23.").arg(ruleCombo->currentText()));
+        return;
+    }
 
     if (settings) {
         settings->setValue("simple_width", newWidth);
         settings->setValue("simple_height", newHeight);
         settings->setValue("simple_initial_fill", newProb);
+        settings->setValue("simple_engine", int(newEngine));
+        settings->setValue("simple_rule", QString::fromLatin1(newRule.toString().c_str()));
+        settings->setValue("simple_max_period", newMaxPeriod);
 
         settings->value("simple_red", newRed);
         settings->value("simple_green", newGreen);
         settings->value("simple_blue", newBlue);
+        settings->setValue("simple_seed", newSeed);
 
         settings->sync();
     }
@@ -105,6 +163,10 @@ void SimpleLifeConfig::finish() {
     life->setDim(newWidth, newHeight);
     life->setProb(newProb);
     life->setRGB(newRed, newGreen, newBlue);
+    life->setEngine(newEngine);
+    life->setRule(newRule);
+    life->setMaxPeriod(newMaxPeriod);
+    life->setSeed(newSeed);
 
     this->close();
 
@@ -26,6 +26,7 @@
 class QPushButton;
 class QLineEdit;
 class QLabel;
+class QComboBox;
 class QSettings;
 
 class SimpleLifeConfig : public QDialog {
@@ -45,6 +46,12 @@ private:
     QLineEdit *greenEdit;
     QLineEdit *blueEdit;
 
+    QLineEdit *seedEdit;
+
+    QComboBox *engineCombo;
+    QComboBox *ruleCombo;
+    QLineEdit *periodEdit;
+
     QPushButton *okayButton;
     QPushButton *cancelButton;
 
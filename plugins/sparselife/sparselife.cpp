@@ -0,0 +1,237 @@
+/*
+  sparselife.cpp
+
+  Copyright (c) 2011, Jeremiah LaRocco jeremiah.larocco@gmail.com
+
+  Permission to use, copy, modify, and/or distribute this software for any
+  purpose with or without fee is hereby granted, provided that the above
+  copyright notice and this permission notice appear in all copies.
+
+  THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+  WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+  MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+  ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+  WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+  ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+  OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+
+#include <QtGui>
+#include <QDebug>
+
+#include <QSettings>
+
+#include <cstdlib>
+
+#include "sparselife.h"
+
+#include "sparselifeconfig.h"
+
+SparseLife::SparseLife() : width(128), height(128), prob(0.4), r(0),g(1),b(1),
+                           viewWidth(1), viewHeight(1),
+                           seed(0), boardSeed(0), settings(0) {
+}
+
+void SparseLife::readSettings(QSettings *sets) {
+    settings = sets;
+
+    width = sets->value("sparse_width", 128).toInt();
+    height = sets->value("sparse_height", 128).toInt();
+
+    prob = sets->value("sparse_initial_fill", 0.4).toFloat();
+
+    r = sets->value("sparse_red", 0.0).toFloat();
+    g = sets->value("sparse_green", 0.8).toFloat();
+    b = sets->value("sparse_blue", 0.4).toFloat();
+
+    LifeRule newRule;
+    if (newRule.parse(sets->value("sparse_rule", "B3/S23").toString().toLatin1().constData()) &&
+        !(newRule.birth & 1)) {
+        setRule(newRule);
+    }
+
+    seed = sets->value("sparse_seed", 0).toULongLong();
+
+    reset();
+}
+
+void SparseLife::configure(QWidget *parent, QSettings *sets) {
+    SparseLifeConfig *cfgDlg = new SparseLifeConfig(this, sets, parent);
+    cfgDlg->show();
+}
+
+SparseLife::~SparseLife() {
+    plane.clear();
+}
+
+QString SparseLife::name() {
+    return tr("Sparse Life");
+}
+
+QString SparseLife::description() {
+    return tr("Conway's game of life on an unbounded plane, stored as 64x64 chunks that come and go with the live cells.");
+}
+
+QString SparseLife::engineInfo() {
+    return tr("Sparse plane, %1, seed %2, %3 chunks, population %4")
+        .arg(QString::fromLatin1(plane.rule().toString().c_str()))
+        .arg(boardSeed)
+        .arg(qulonglong(plane.chunkCount()))
+        .arg(qulonglong(plane.population()));
+}
+
+double SparseLife::population() {
+    return double(plane.population());
+}
+
+bool SparseLife::allowViewManipulation() {
+    return false;
+}
+
+void SparseLife::initView() {
+    glClearColor(0,0,0,0);
+    glShadeModel(GL_SMOOTH);
+    glDisable(GL_LIGHTING);
+
+    glDisable(GL_LIGHT0);
+}
+
+void SparseLife::resizeView(int width, int height) {
+    viewWidth = width > 0 ? width : 1;
+    viewHeight = height > 0 ? height : 1;
+
+    glViewport(0,0, (GLsizei) width, (GLsizei)height);
+    glMatrixMode(GL_MODELVIEW);
+
+    glClear(GL_COLOR_BUFFER_BIT);
+}
+
+bool SparseLife::evolve() {
+    plane.evolve();
+    return false;
+}
+
+void SparseLife::draw() {
+    glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+    glPolygonMode(GL_FRONT_AND_BACK, GL_FILL);
+
+    int64_t minX, minY, maxX, maxY;
+    if (!plane.chunkBounds(minX, minY, maxX, maxY)) {
+        glFlush();
+        return;
+    }
+
+    // Fit the chunks in the window, keeping cells square
+    const int size = SparseChunk::SIZE;
+    double spanX = double(maxX - minX + 1)*size;
+    double spanY = double(maxY - minY + 1)*size;
+    double pixelSize = qMax(spanX/viewWidth, spanY/viewHeight);
+    double visibleWidth = pixelSize*viewWidth;
+    double visibleHeight = pixelSize*viewHeight;
+
+    glMatrixMode(GL_PROJECTION);
+    glLoadIdentity();
+    gluOrtho2D(0, visibleWidth, visibleHeight, 0);
+    glMatrixMode(GL_MODELVIEW);
+    glLoadIdentity();
+
+    double offX = 0.5*(visibleWidth - spanX);
+    double offY = 0.5*(visibleHeight - spanY);
+
+    glColor3f(r,g,b);
+    glBegin(GL_QUADS);
+    for (size_t i=0; i<plane.chunkCount(); ++i) {
+        const SparseChunk *c = plane.chunk(i);
+        const uint64_t *rows = plane.chunkRows(c);
+        double left = offX + double(c->cx - minX)*size;
+        double top = offY + double(c->cy - minY)*size;
+        for (int row=0; row<size; ++row) {
+            uint64_t bits = rows[row];
+            double cy = top + row;
+            for (int col=0; bits; ++col, bits >>= 1) {
+                if (bits & 1) {
+                    double cx = left + col;
+                    glVertex2d(cx, cy);
+                    glVertex2d(cx+1, cy);
+                    glVertex2d(cx+1, cy+1);
+                    glVertex2d(cx, cy+1);
+                }
+            }
+        }
+    }
+    glEnd();
+
+    glFlush();
+}
+
+void SparseLife::reset() {
+    plane.clear();
+
+    boardSeed = seed ? seed : lifeNewSeed();
+    if (settings) {
+        settings->setValue("sparse_last_seed", boardSeed);
+    }
+
+    // Same words as SimpleLife's board, centered on the origin
+    LifeBernoulli bits(boardSeed, prob);
+    int words = (width+63)/64;
+    for (int i=0; i<height; ++i) {
+        for (int k=0; k<words; ++k) {
+            uint64_t word = bits.word(uint64_t(i)*words + k);
+            if (k == words-1 && (width & 63)) {
+                word &= (uint64_t(1) << (width & 63)) - 1;
+            }
+            while (word) {
+                int n = __builtin_ctzll(word);
+                word &= word - 1;
+                plane.setCell(int64_t(64*k + n) - width/2, int64_t(i) - height/2, true);
+            }
+        }
+    }
+}
+
+void SparseLife::setRGB(double red, double green, double blue) {
+    r = red;
+    g = green;
+    b = blue;
+}
+
+void SparseLife::getRGB(double &red, double &green, double &blue) {
+    red = r;
+    green = g;
+    blue = b;
+}
+
+void SparseLife::setProb(double probability) {
+    prob = probability;
+}
+
+void SparseLife::getProb(double &probability) {
+    probability = prob;
+}
+
+void SparseLife::setDim(int w, int h) {
+    width = w;
+    height = h;
+}
+void SparseLife::getDim(int &w, int &h) {
+    w = width;
+    h = height;
+}
+
+void SparseLife::setRule(const LifeRule &newRule) {
+    plane.setRule(newRule);
+}
+void SparseLife::getRule(LifeRule &curRule) {
+    curRule = plane.rule();
+}
+
+void SparseLife::setSeed(quint64 newSeed) {
+    seed = newSeed;
+}
+void SparseLife::getSeed(quint64 &curSeed) {
+    curSeed = seed;
+}
+
+
+Q_EXPORT_PLUGIN2(sparselife, SparseLife)
@@ -0,0 +1,11 @@
+TEMPLATE      = lib
+CONFIG       += plugin
+
+QT += opengl
+
+HEADERS       = sparselife.h sparselifeconfig.h sparseplane.h
+SOURCES       = sparselife.cpp sparselifeconfig.cpp sparseplane.cpp
+
+DESTDIR       = ../../bin/plugins
+
+INCLUDEPATH   += ../../src
@@ -0,0 +1,148 @@
+/*
+  sparselifeconfig.cpp
+
+  Copyright (c) 2011, Jeremiah LaRocco jeremiah.larocco@gmail.com
+
+  Permission to use, copy, modify, and/or distribute this software for any
+  purpose with or without fee is hereby granted, provided that the above
+  copyright notice and this permission notice appear in all copies.
+
+  THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+  WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+  MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+  ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+  WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+  ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+  OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+
+#include <QtGui>
+
+#include "sparselifeconfig.h"
+
+SparseLifeConfig::SparseLifeConfig(SparseLife *sl,
+                                   QSettings *sets,
+                                   QWidget *parent) : QDialog(parent),
+                                                      life(sl),
+                                                      settings(sets) {
+
+    QGridLayout *layout = new QGridLayout();
+    int curRow = 0;
+
+    int width, height;
+    life->getDim(width, height);
+
+    layout->addWidget(new QLabel(tr("Width")), curRow, 0);
+    widthEdit = new QLineEdit(tr("%1").arg(width));
+    layout->addWidget(widthEdit, curRow, 1);
+    curRow+=1;
+
+    layout->addWidget(new QLabel(tr("Height")), curRow, 0);
+    heightEdit = new QLineEdit(tr("%1").arg(height));
+    layout->addWidget(heightEdit, curRow, 1);
+    curRow+=1;
+
+    double prob;
+    life->getProb(prob);
+    layout->addWidget(new QLabel(tr("Percent fill")), curRow, 0);
+    probEdit = new QLineEdit(tr("%1").arg(prob,0,'g', 3));
+    layout->addWidget(probEdit, curRow, 1);
+    curRow += 1;
+
+    double r,g,b;
+    life->getRGB(r,g,b);
+
+    layout->addWidget(new QLabel(tr("Red")), curRow, 0);
+    redEdit = new QLineEdit(tr("%1").arg(r,0,'g', 3));
+    layout->addWidget(redEdit, curRow, 1);
+    curRow += 1;
+
+    layout->addWidget(new QLabel(tr("Green")), curRow, 0);
+    greenEdit = new QLineEdit(tr("%1").arg(g,0,'g', 3));
+    layout->addWidget(greenEdit, curRow, 1);
+    curRow += 1;
+
+    layout->addWidget(new QLabel(tr("Blue")), curRow, 0);
+    blueEdit = new QLineEdit(tr("%1").arg(b,0,'g', 3));
+    layout->addWidget(blueEdit, curRow, 1);
+    curRow += 1;
+
+    LifeRule rule;
+    life->getRule(rule);
+    layout->addWidget(new QLabel(tr("Rule")), curRow, 0);
+    ruleCombo = new QComboBox;
+    ruleCombo->setEditable(true);
+    ruleCombo->addItem("B3/S23");
+    ruleCombo->addItem("B36/S23");
+    ruleCombo->addItem("B3678/S34678");
+    ruleCombo->addItem("B2/S");
+    ruleCombo->setEditText(QString::fromLatin1(rule.toString().c_str()));
+    layout->addWidget(ruleCombo, curRow, 1);
+    curRow += 1;
+
+    quint64 seed;
+    life->getSeed(seed);
+    layout->addWidget(new QLabel(tr("Seed (0 for a new one each reset)")), curRow, 0);
+    seedEdit = new QLineEdit(tr("%1").arg(seed));
+    layout->addWidget(seedEdit, curRow, 1);
+    curRow += 1;
+
+    okayButton = new QPushButton(tr("Okay"));
+    layout->addWidget(okayButton, curRow, 0);
+    connect(okayButton, SIGNAL(clicked()), this, SLOT(finish()));
+
+    cancelButton = new QPushButton(tr("Cancel"));
+    connect(cancelButton, SIGNAL(clicked()), this, SLOT(close()));
+    layout->addWidget(cancelButton, curRow, 1);
+    curRow += 1;
+
+    setLayout(layout);
+}
+
+void SparseLifeConfig::finish() {
+    int newWidth = widthEdit->text().toInt();
+    int newHeight = heightEdit->text().toInt();
+
+    double newProb = probEdit->text().toDouble();
+    double newRed = redEdit->text().toDouble();
+    double newGreen = greenEdit->text().toDouble();
+    double newBlue = blueEdit->text().toDouble();
+    quint64 newSeed = seedEdit->text().toULongLong();
+
+    LifeRule newRule;
+    if (!newRule.parse(ruleCombo->currentText().toLatin1().constData())) {
+        QMessageBox::warning(this, tr("Sparse Life"),
+                             tr("\"%1\" is not a rule like B3/S23.").arg(ruleCombo->currentText()));
+        return;
+    }
+    // Birth on zero neighbors would fill the whole plane at once
+    if (newRule.birth & 1) {
+        QMessageBox::warning(this, tr("Sparse Life"),
+                             tr("Rules with B0 need a bounded board."));
+        return;
+    }
+
+    if (settings) {
+        settings->setValue("sparse_width", newWidth);
+        settings->setValue("sparse_height", newHeight);
+        settings->setValue("sparse_initial_fill", newProb);
+        settings->setValue("sparse_rule", QString::fromLatin1(newRule.toString().c_str()));
+
+        settings->setValue("sparse_red", newRed);
+        settings->setValue("sparse_green", newGreen);
+        settings->setValue("sparse_blue", newBlue);
+        settings->setValue("sparse_seed", newSeed);
+
+        settings->sync();
+    }
+
+    life->setDim(newWidth, newHeight);
+    life->setProb(newProb);
+    life->setRGB(newRed, newGreen, newBlue);
+    life->setRule(newRule);
+    life->setSeed(newSeed);
+
+    this->close();
+
+    life->reset();
+}
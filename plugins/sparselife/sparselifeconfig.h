@@ -0,0 +1,60 @@
+/*
+  sparselifeconfig.h
+
+  Copyright (c) 2011, Jeremiah LaRocco jeremiah.larocco@gmail.com
+
+  Permission to use, copy, modify, and/or distribute this software for any
+  purpose with or without fee is hereby granted, provided that the above
+  copyright notice and this permission notice appear in all copies.
+
+  THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+  WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+  MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+  ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+  WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+  ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+  OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+
+#ifndef SPARSE_LIFE_CONFIG_INCLUDE_H
+#define SPARSE_LIFE_CONFIG_INCLUDE_H
+
+#include <QDialog>
+
+#include "sparselife.h"
+
+class QPushButton;
+class QLineEdit;
+class QLabel;
+class QComboBox;
+class QSettings;
+
+class SparseLifeConfig : public QDialog {
+    Q_OBJECT;
+public:
+    SparseLifeConfig(SparseLife *sl, QSettings *sets=0, QWidget *parent = 0);
+
+public slots:
+    void finish();
+
+private:
+    QLineEdit *widthEdit;
+    QLineEdit *heightEdit;
+    QLineEdit *probEdit;
+
+    QLineEdit *redEdit;
+    QLineEdit *greenEdit;
+    QLineEdit *blueEdit;
+
+    QLineEdit *seedEdit;
+
+    QComboBox *ruleCombo;
+
+    QPushButton *okayButton;
+    QPushButton *cancelButton;
+
+    SparseLife *life;
+    QSettings *settings;
+};
+
+#endif
@@ -0,0 +1,317 @@
+/*
+  sparseplane.cpp
+
+  Copyright (c) 2011, Jeremiah LaRocco jeremiah.larocco@gmail.com
+
+  Permission to use, copy, modify, and/or distribute this software for any
+  purpose with or without fee is hereby granted, provided that the above
+  copyright notice and this permission notice appear in all copies.
+
+  THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+  WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+  MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+  ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+  WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+  ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+  OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+
+#include <string.h>
+
+#include "sparseplane.h"
+
+#include "lifebits.h"
+#include "lifeparallel.h"
+
+static const size_t CHUNK_BLOCK = 256;
+static const size_t MIN_TABLE = 1024;
+
+static const uint64_t NO_CELLS[SparseChunk::SIZE] = { 0 };
+
+// Neighbor order in NB_DX/NB_DY, and in the edge[] and nb[] arrays indexed
+// with them
+enum { NB_NW, NB_N, NB_NE, NB_W, NB_E, NB_SW, NB_S, NB_SE };
+static const int NB_DX[8] = { -1, 0, 1, -1, 1, -1, 0, 1 };
+static const int NB_DY[8] = { -1, -1, -1, 0, 0, 1, 1, 1 };
+
+static inline size_t hashChunk(int64_t cx, int64_t cy) {
+    uint64_t h = uint64_t(cx)*0x9E3779B97F4A7C15ULL + uint64_t(cy);
+    h *= 0x9E3779B97F4A7C15ULL;
+    return size_t(h ^ (h >> 29));
+}
+
+// Floor division by the chunk size, also for negative coordinates
+static inline int64_t chunkOf(int64_t v) {
+    return v >= 0 ? v/SparseChunk::SIZE : -((-v-1)/SparseChunk::SIZE) - 1;
+}
+
+SparsePlane::SparsePlane() : freeList(0), cur(0) {
+    table.assign(MIN_TABLE, 0);
+}
+
+SparsePlane::~SparsePlane() {
+    for (size_t i=0; i<blocks.size(); ++i) {
+        delete [] blocks[i];
+    }
+}
+
+void SparsePlane::clear() {
+    for (size_t i=0; i<blocks.size(); ++i) {
+        delete [] blocks[i];
+    }
+    blocks.clear();
+    chunks.clear();
+    freeList = 0;
+    table.assign(MIN_TABLE, 0);
+}
+
+SparseChunk *SparsePlane::find(int64_t cx, int64_t cy) const {
+    size_t slot = hashChunk(cx, cy) & (table.size()-1);
+    for (SparseChunk *c = table[slot]; c; c = c->next) {
+        if (c->cx == cx && c->cy == cy) {
+            return c;
+        }
+    }
+    return 0;
+}
+
+SparseChunk *SparsePlane::findOrCreate(int64_t cx, int64_t cy) {
+    SparseChunk *c = find(cx, cy);
+    if (c) {
+        return c;
+    }
+
+    if (!freeList) {
+        SparseChunk *block = new SparseChunk[CHUNK_BLOCK];
+        blocks.push_back(block);
+        for (size_t i=0; i<CHUNK_BLOCK; ++i) {
+            block[i].next = freeList;
+            freeList = &block[i];
+        }
+    }
+    c = freeList;
+    freeList = c->next;
+
+    c->cx = cx;
+    c->cy = cy;
+    memset(c->rows, 0, sizeof(c->rows));
+
+    size_t slot = hashChunk(cx, cy) & (table.size()-1);
+    c->next = table[slot];
+    table[slot] = c;
+    chunks.push_back(c);
+
+    if (chunks.size() > table.size()) {
+        rehash(table.size()*2);
+    }
+    return c;
+}
+
+// Unlinks c from the hash table and returns it to the free list
+void SparsePlane::remove(SparseChunk *c) {
+    size_t slot = hashChunk(c->cx, c->cy) & (table.size()-1);
+    SparseChunk **link = &table[slot];
+    while (*link != c) {
+        link = &(*link)->next;
+    }
+    *link = c->next;
+    c->next = freeList;
+    freeList = c;
+}
+
+void SparsePlane::rehash(size_t size) {
+    std::vector<SparseChunk *> old(size, (SparseChunk *)0);
+    old.swap(table);
+    for (size_t i=0; i<old.size(); ++i) {
+        SparseChunk *c = old[i];
+        while (c) {
+            SparseChunk *next = c->next;
+            size_t slot = hashChunk(c->cx, c->cy) & (table.size()-1);
+            c->next = table[slot];
+            table[slot] = c;
+            c = next;
+        }
+    }
+}
+
+void SparsePlane::setCell(int64_t x, int64_t y, bool alive) {
+    int64_t cx = chunkOf(x), cy = chunkOf(y);
+    int col = int(x - cx*SparseChunk::SIZE);
+    int row = int(y - cy*SparseChunk::SIZE);
+    uint64_t bit = uint64_t(1) << col;
+    if (alive) {
+        findOrCreate(cx, cy)->rows[cur][row] |= bit;
+    } else {
+        SparseChunk *c = find(cx, cy);
+        if (c) {
+            c->rows[cur][row] &= ~bit;
+        }
+    }
+}
+
+bool SparsePlane::getCell(int64_t x, int64_t y) const {
+    int64_t cx = chunkOf(x), cy = chunkOf(y);
+    const SparseChunk *c = find(cx, cy);
+    if (!c) {
+        return false;
+    }
+    int col = int(x - cx*SparseChunk::SIZE);
+    int row = int(y - cy*SparseChunk::SIZE);
+    return (c->rows[cur][row] >> col) & 1;
+}
+
+/*
+  Makes sure every chunk that could have a birth next generation exists:
+  a live cell on a chunk's edge or corner can bring the neighbor across
+  that edge or corner to life.
+*/
+void SparsePlane::growBorders() {
+    const int last = SparseChunk::SIZE-1;
+    const uint64_t westBit = 1, eastBit = uint64_t(1) << last;
+
+    size_t count = chunks.size();
+    for (size_t i=0; i<count; ++i) {
+        SparseChunk *c = chunks[i];
+        const uint64_t *rows = c->rows[cur];
+
+        uint64_t any = 0;
+        for (int r=0; r<SparseChunk::SIZE; ++r) {
+            any |= rows[r];
+        }
+        if (!any) {
+            continue;
+        }
+        bool edge[8];
+        edge[NB_N] = rows[0] != 0;
+        edge[NB_S] = rows[last] != 0;
+        edge[NB_W] = (any & westBit) != 0;
+        edge[NB_E] = (any & eastBit) != 0;
+        edge[NB_NW] = (rows[0] & westBit) != 0;
+        edge[NB_NE] = (rows[0] & eastBit) != 0;
+        edge[NB_SW] = (rows[last] & westBit) != 0;
+        edge[NB_SE] = (rows[last] & eastBit) != 0;
+
+        for (int n=0; n<8; ++n) {
+            if (edge[n]) {
+                findOrCreate(c->cx + NB_DX[n], c->cy + NB_DY[n]);
+            }
+        }
+    }
+}
+
+void SparsePlane::setRule(const LifeRule &newRule) {
+    lifeRule = newRule;
+}
+
+// Picks the chunk loop compiled for the current rule
+void SparsePlane::evolveChunks(int begin, int end) {
+    switch (lifeRule.kind()) {
+    case LifeRule::Conway:
+        evolveRuleChunks<ConwayRule>(begin, end);
+        break;
+    case LifeRule::HighLife:
+        evolveRuleChunks<HighLifeRule>(begin, end);
+        break;
+    case LifeRule::DayAndNight:
+        evolveRuleChunks<DayAndNightRule>(begin, end);
+        break;
+    case LifeRule::Seeds:
+        evolveRuleChunks<SeedsRule>(begin, end);
+        break;
+    default:
+        evolveRuleChunks<MaskRule>(begin, end);
+        break;
+    }
+}
+
+template <class Rule>
+void SparsePlane::evolveRuleChunks(int begin, int end) {
+    Rule rule(lifeRule);
+    const int last = SparseChunk::SIZE-1;
+    int src = cur, dst = 1-cur;
+
+    for (int i=begin; i<end; ++i) {
+        SparseChunk *c = chunks[i];
+
+        // Lookups only read the table, so bands can do them at the same time
+        const uint64_t *nb[8];
+        for (int n=0; n<8; ++n) {
+            const SparseChunk *other = find(c->cx + NB_DX[n], c->cy + NB_DY[n]);
+            nb[n] = other ? other->rows[src] : NO_CELLS;
+        }
+        const uint64_t *m = c->rows[src];
+        uint64_t *out = c->rows[dst];
+
+        for (int r=0; r<SparseChunk::SIZE; ++r) {
+            uint64_t u, uw, ue, d, dw, de;
+            if (r > 0) {
+                u = m[r-1]; uw = nb[NB_W][r-1]; ue = nb[NB_E][r-1];
+            } else {
+                u = nb[NB_N][last]; uw = nb[NB_NW][last]; ue = nb[NB_NE][last];
+            }
+            if (r < last) {
+                d = m[r+1]; dw = nb[NB_W][r+1]; de = nb[NB_E][r+1];
+            } else {
+                d = nb[NB_S][0]; dw = nb[NB_SW][0]; de = nb[NB_SE][0];
+            }
+            uint64_t mid = m[r], mw = nb[NB_W][r], me = nb[NB_E][r];
+
+            out[r] = ruleWord(rule, (u << 1) | (uw >> 63), u, (u >> 1) | (ue << 63),
+                              (mid << 1) | (mw >> 63), mid, (mid >> 1) | (me << 63),
+                              (d << 1) | (dw >> 63), d, (d >> 1) | (de << 63));
+        }
+    }
+}
+
+// Frees the chunks that died, they come back if a neighbor needs them
+void SparsePlane::dropEmpty() {
+    size_t kept = 0;
+    for (size_t i=0; i<chunks.size(); ++i) {
+        SparseChunk *c = chunks[i];
+        const uint64_t *rows = c->rows[cur];
+        uint64_t any = 0;
+        for (int r=0; r<SparseChunk::SIZE; ++r) {
+            any |= rows[r];
+        }
+        if (any) {
+            chunks[kept++] = c;
+        } else {
+            remove(c);
+        }
+    }
+    chunks.resize(kept);
+}
+
+void SparsePlane::evolve() {
+    growBorders();
+    parallelBands(int(chunks.size()), this, &SparsePlane::evolveChunks, 4);
+    cur = 1-cur;
+    dropEmpty();
+}
+
+uint64_t SparsePlane::population() const {
+    uint64_t total = 0;
+    for (size_t i=0; i<chunks.size(); ++i) {
+        const uint64_t *rows = chunks[i]->rows[cur];
+        for (int r=0; r<SparseChunk::SIZE; ++r) {
+            total += __builtin_popcountll(rows[r]);
+        }
+    }
+    return total;
+}
+
+bool SparsePlane::chunkBounds(int64_t &minX, int64_t &minY, int64_t &maxX, int64_t &maxY) const {
+    if (chunks.empty()) {
+        return false;
+    }
+    minX = maxX = chunks[0]->cx;
+    minY = maxY = chunks[0]->cy;
+    for (size_t i=1; i<chunks.size(); ++i) {
+        const SparseChunk *c = chunks[i];
+        if (c->cx < minX) minX = c->cx;
+        if (c->cx > maxX) maxX = c->cx;
+        if (c->cy < minY) minY = c->cy;
+        if (c->cy > maxY) maxY = c->cy;
+    }
+    return true;
+}
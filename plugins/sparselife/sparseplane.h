@@ -0,0 +1,93 @@
+/*
+  sparseplane.h
+
+  Copyright (c) 2011, Jeremiah LaRocco jeremiah.larocco@gmail.com
+
+  Permission to use, copy, modify, and/or distribute this software for any
+  purpose with or without fee is hereby granted, provided that the above
+  copyright notice and this permission notice appear in all copies.
+
+  THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+  WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+  MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+  ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+  WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+  ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+  OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+
+#ifndef SPARSE_PLANE_INCLUDE_H
+#define SPARSE_PLANE_INCLUDE_H
+
+#include <vector>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "liferule.h"
+
+/*
+  A 64x64 block of the plane.  Bit n of row r holds cell (64*cx+n, 64*cy+r).
+  Both generations are kept in the chunk so evolving never allocates.
+*/
+struct SparseChunk {
+    static const int SIZE = 64;
+
+    int64_t cx, cy;
+    uint64_t rows[2][SIZE];
+
+    // Hash chain, or the free list for unused chunks
+    SparseChunk *next;
+};
+
+/*
+  An unbounded plane stored as a hash map of chunks.  Only chunks with live
+  cells are kept, plus a ring of empty ones where live cells touch a chunk
+  border, so memory and time follow the live area rather than the bounding
+  box.
+*/
+class SparsePlane {
+public:
+    SparsePlane();
+    ~SparsePlane();
+
+    void clear();
+
+    void setCell(int64_t x, int64_t y, bool alive);
+    bool getCell(int64_t x, int64_t y) const;
+
+    // Rules with B0 would fill the whole plane and aren't supported
+    void setRule(const LifeRule &newRule);
+    const LifeRule &rule() const { return lifeRule; }
+
+    void evolve();
+
+    size_t chunkCount() const { return chunks.size(); }
+    const SparseChunk *chunk(size_t i) const { return chunks[i]; }
+    const uint64_t *chunkRows(const SparseChunk *c) const { return c->rows[cur]; }
+
+    uint64_t population() const;
+
+    // Chunk coordinates covering every chunk, false if there are none
+    bool chunkBounds(int64_t &minX, int64_t &minY, int64_t &maxX, int64_t &maxY) const;
+
+private:
+    SparseChunk *find(int64_t cx, int64_t cy) const;
+    SparseChunk *findOrCreate(int64_t cx, int64_t cy);
+    void remove(SparseChunk *c);
+    void rehash(size_t size);
+
+    void growBorders();
+    void evolveChunks(int begin, int end);
+    template <class Rule>
+    void evolveRuleChunks(int begin, int end);
+    void dropEmpty();
+
+    std::vector<SparseChunk *> table;
+    std::vector<SparseChunk *> chunks;
+    std::vector<SparseChunk *> blocks;
+    SparseChunk *freeList;
+    int cur;
+    LifeRule lifeRule;
+};
+
+#endif
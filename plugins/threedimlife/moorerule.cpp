@@ -0,0 +1,166 @@
+/*
+  moorerule.cpp
+  
+  Copyright (c) 2011, Jeremiah LaRocco jeremiah.larocco@gmail.com
+
+  Permission to use, copy, modify, and/or distribute this software for any
+  purpose with or without fee is hereby granted, provided that the above
+  copyright notice and this permission notice appear in all copies.
+
+  THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+  WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+  MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+  ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+  WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+  ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+  OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "moorerule.h"
+
+// Reads a number at text, or returns false
+static bool readInt(const char *&text, int &value) {
+    if (*text < '0' || *text > '9') {
+        return false;
+    }
+    char *end;
+    value = int(strtol(text, &end, 10));
+    text = end;
+    return true;
+}
+
+// Sets bits low..high of mask, false if the range isn't valid
+static bool setRange(unsigned int &mask, int low, int high) {
+    if (low > high || high > MooreRule::MAX_NEIGHBORS) {
+        return false;
+    }
+    for (int n=low; n<=high; ++n) {
+        mask |= 1u << n;
+    }
+    return true;
+}
+
+// Reads "a..b,c,..." up to the next '/' or the end of text
+static bool readCounts(const char *&text, unsigned int &mask) {
+    while (*text && *text != '/') {
+        int low, high;
+        if (!readInt(text, low)) {
+            return false;
+        }
+        high = low;
+        if (text[0] == '.' && text[1] == '.') {
+            text += 2;
+            if (!readInt(text, high)) {
+                return false;
+            }
+        }
+        if (!setRange(mask, low, high)) {
+            return false;
+        }
+        if (*text == ',') {
+            ++text;
+        }
+    }
+    return true;
+}
+
+bool MooreRule::parse(const char *text) {
+    MooreRule rule;
+    rule.birth = 0;
+    rule.survive = 0;
+
+    // Bays' El Eu Fl Fu, one digit each
+    bool bays = true;
+    int len = 0;
+    for (; text[len]; ++len) {
+        bays = bays && text[len] >= '0' && text[len] <= '9';
+    }
+    if (bays && len == 4) {
+        if (!setRange(rule.survive, text[0]-'0', text[1]-'0') ||
+            !setRange(rule.birth, text[2]-'0', text[3]-'0')) {
+            return false;
+        }
+        *this = rule;
+        return true;
+    }
+
+    bool haveBirth = false, haveSurvive = false;
+    const char *c = text;
+    while (*c) {
+        char key = *c++;
+        bool ok = true;
+        switch (key) {
+        case 'B': case 'b':
+            ok = !haveBirth && readCounts(c, rule.birth);
+            haveBirth = true;
+            break;
+        case 'S': case 's':
+            ok = !haveSurvive && readCounts(c, rule.survive);
+            haveSurvive = true;
+            break;
+        case '/':
+            break;
+        default:
+            ok = false;
+        }
+        if (!ok) {
+            return false;
+        }
+    }
+    if (!haveBirth || !haveSurvive) {
+        return false;
+    }
+    *this = rule;
+    return true;
+}
+
+// Writes mask as counts and ranges, e.g. "4..5,7"
+static std::string countsString(unsigned int mask) {
+    std::string text;
+    char num[32];
+    int n = 0;
+    while (n <= MooreRule::MAX_NEIGHBORS) {
+        if (!((mask >> n) & 1)) {
+            ++n;
+            continue;
+        }
+        int high = n;
+        while (high < MooreRule::MAX_NEIGHBORS && ((mask >> (high+1)) & 1)) {
+            ++high;
+        }
+        if (!text.empty()) {
+            text += ",";
+        }
+        if (high > n) {
+            snprintf(num, sizeof(num), "%d..%d", n, high);
+        } else {
+            snprintf(num, sizeof(num), "%d", n);
+        }
+        text += num;
+        n = high + 1;
+    }
+    return text;
+}
+
+// True if mask is one run of counts from 0 to 9, stored in low and high
+static bool singleDigitRange(unsigned int mask, int &low, int &high) {
+    if (mask == 0 || mask >= (1u << 10)) {
+        return false;
+    }
+    low = __builtin_ctz(mask);
+    high = 31 - __builtin_clz(mask);
+    return mask == ((2u << high) - (1u << low));
+}
+
+std::string MooreRule::toString() const {
+    int el, eu, fl, fu;
+    if (singleDigitRange(survive, el, eu) && singleDigitRange(birth, fl, fu)) {
+        char text[8];
+        snprintf(text, sizeof(text), "%d%d%d%d", el, eu, fl, fu);
+        return text;
+    }
+    return "B" + countsString(birth) + "/S" + countsString(survive);
+}
@@ -0,0 +1,73 @@
+/*
+  moorerule.h
+  
+  Copyright (c) 2011, Jeremiah LaRocco jeremiah.larocco@gmail.com
+
+  Permission to use, copy, modify, and/or distribute this software for any
+  purpose with or without fee is hereby granted, provided that the above
+  copyright notice and this permission notice appear in all copies.
+
+  THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+  WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+  MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+  ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+  WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+  ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+  OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+
+#ifndef MOORE_RULE_INCLUDE_H
+#define MOORE_RULE_INCLUDE_H
+
+#include <string>
+#include <stdint.h>
+
+/*
+  An outer totalistic rule over the 26 cells of the 3D Moore neighborhood.
+  Bit n of birth is set if a dead cell with n live neighbors comes alive,
+  bit n of survive if a live one stays alive.
+
+  Written in Bays' notation, e.g. "4555" for survival with 4 to 5 live
+  neighbors and birth with 5 to 5, or as "B5/S4,5" where counts are
+  separated by commas and "a..b" is a range, e.g. "B5..7/S6,8..10".
+*/
+struct MooreRule {
+    static const int MAX_NEIGHBORS = 26;
+
+    unsigned int birth;
+    unsigned int survive;
+
+    // Bays' 4555
+    MooreRule() : birth(1u<<5), survive((1u<<4) | (1u<<5)) {}
+
+    bool next(bool alive, int num) const {
+        return ((alive ? survive : birth) >> num) & 1;
+    }
+
+    // next() for 64 cells at once.  count holds the five bits of the number
+    // of live cells in the 3x3x3 box around each cell, the cell included.
+    uint64_t apply(const uint64_t *count, uint64_t alive) const {
+        return (alive & matchCount(count, survive << 1)) | (~alive & matchCount(count, birth));
+    }
+
+    // Bits of the cells whose count is one of the bits set in mask
+    static uint64_t matchCount(const uint64_t *count, unsigned int mask) {
+        uint64_t match = 0;
+        while (mask) {
+            int n = __builtin_ctz(mask);
+            mask &= mask - 1;
+            uint64_t eq = ~uint64_t(0);
+            for (int b=0; b<5; ++b) {
+                eq &= ((n >> b) & 1) ? count[b] : ~count[b];
+            }
+            match |= eq;
+        }
+        return match;
+    }
+
+    // Leaves the rule alone and returns false if text isn't a valid rule
+    bool parse(const char *text);
+    std::string toString() const;
+};
+
+#endif
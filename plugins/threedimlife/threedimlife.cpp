@@ -25,13 +25,14 @@
 
 #include "threedimlife.h"
 
-#include "threedimlifeconfig.h"
+#include "lifeparallel.h"
 
-size_t randUInt(size_t min, size_t max) {
-    return ((std::rand()%(max-min)) + min);
-}
+#include "threedimlifeconfig.h"
 
-ThreeDimLife::ThreeDimLife() : width(32), height(32), depth(32), prob(0.4), r(0),g(1),b(1) {
+ThreeDimLife::ThreeDimLife() : width(32), height(32), depth(32), prob(0.4), r(0),g(1),b(1),
+                               maxPeriod(32), generation(0),
+                               seed(0), boardSeed(0), fillBits(0), settings(0),
+                               meshList(0), listGeneration(0), listStale(true) {
     zoomAmount=75;
     rotateX = 45.0;
     rotateY = 45.0;
@@ -39,6 +40,8 @@ ThreeDimLife::ThreeDimLife() : width(32), height(32), depth(32), prob(0.4), r(0)
 }
 
 void ThreeDimLife::readSettings(QSettings *sets) {
+    settings = sets;
+
     width = sets->value("three_dim_width", 32).toInt();
     height = sets->value("three_dim_height", 32).toInt();
     depth = sets->value("three_dim_depth", 32).toInt();
@@ -49,6 +52,14 @@ void ThreeDimLife::readSettings(QSettings *sets) {
     g = sets->value("three_dim_green", 0.8).toFloat();
     b = sets->value("three_dim_blue", 0.4).toFloat();
 
+    MooreRule newRule;
+    if (newRule.parse(sets->value("three_dim_moore_rule", "4555").toString().toLatin1().constData())) {
+        rule = newRule;
+    }
+    maxPeriod = sets->value("three_dim_max_period", 32).toInt();
+    seed = sets->value("three_dim_seed", 0).toULongLong();
+    mesh.setMerge(sets->value("three_dim_merge_faces", false).toBool());
+
     reset();
 }
 
@@ -58,7 +69,6 @@ void ThreeDimLife::configure(QWidget *parent, QSettings *sets) {
 }
 
 ThreeDimLife::~ThreeDimLife() {
-    array.clear();
 }
 
 QString ThreeDimLife::name() {
@@ -66,7 +76,25 @@ QString ThreeDimLife::name() {
 }
 
 QString ThreeDimLife::description() {
-    return tr("Traditional Conway's game of life.");
+    return tr("Life in three dimensions, with outer totalistic rules over the 26 cells around each cell.");
+}
+
+QString ThreeDimLife::engineInfo() {
+    QString info = tr("3D Life, %1, seed %2")
+        .arg(QString::fromLatin1(rule.toString().c_str()))
+        .arg(boardSeed);
+    if (history.found() && history.period() == 1) {
+        info += tr(", still life since generation %1").arg(qulonglong(history.foundAt()));
+    } else if (history.found()) {
+        info += tr(", period %1 since generation %2")
+            .arg(history.period())
+            .arg(qulonglong(history.foundAt()));
+    }
+    return info;
+}
+
+double ThreeDimLife::population() {
+    return double(cells.population());
 }
 
 bool ThreeDimLife::allowViewManipulation() {
@@ -94,10 +122,6 @@ void ThreeDimLife::initLights() {
         lmodel_ambient[i][2]=0.4;
         lmodel_ambient[i][3]=1.0;
     }
-
-    glEnable(GL_LIGHTING);
-    glEnable(GL_LIGHT0);
-    glEnable(GL_LIGHT1);
 }
 void ThreeDimLife::initMaterials() {
     // lines
@@ -153,6 +177,22 @@ void ThreeDimLife::initView() {
 
     initLights();
     initMaterials();
+
+    glEnable(GL_LIGHTING);
+    glEnable(GL_LIGHT0);
+    glEnable(GL_LIGHT1);
+
+    // The context may be new, and any list from an old one went with it
+    meshList = 0;
+    listStale = true;
+}
+
+void ThreeDimLife::releaseView() {
+    if (meshList) {
+        glDeleteLists(meshList, 1);
+        meshList = 0;
+    }
+    listStale = true;
 }
 
 void ThreeDimLife::resizeView(int width, int height) {
@@ -169,43 +209,127 @@ void ThreeDimLife::resizeView(int width, int height) {
 bool ThreeDimLife::evolve() {
     // qDebug() << "Evolving";
 
-    int h = height;
-    int w = width;
-    int d = depth;
+    // Both volumes are sized in reset(), evolving only swaps them
+    Q_ASSERT(nextCells.depth() == depth);
+
+    // Neighbor counts are sums over the 3x3x3 box around each cell, taken
+    // one axis at a time with bit-sliced adders, 64 cells per word: along
+    // x, then y within each slab, then across the slabs on either side
+    // once every slab is summed
+    int minBand = 16384/qMax(width*height, 1) + 1;
+    parallelBands(depth, this, &ThreeDimLife::sumPlanes, minBand);
+    parallelBands(depth, this, &ThreeDimLife::evolveSlabs, minBand);
 
-    vector_3d rval;
+    cells.swap(nextCells);
+    ++generation;
 
-    rval.resize(height);
-    for (int i=0; i<height; ++i) {
-        rval[i].resize(width);
-        for (int j=0;j<width; ++j) {
-            rval[i][j].resize(depth, false);
+    // Stop once the board repeats, the first time only so a restarted run
+    // keeps going
+    return history.enabled() && history.record(boardHash(), generation);
+}
+
+uint64_t ThreeDimLife::boardHash() {
+    parallelBands(depth, this, &ThreeDimLife::hashSlabs, 16384/qMax(width*height, 1) + 1);
+    uint64_t total = 0;
+    for (int z=0; z<depth; ++z) {
+        total ^= slabHashes[z];
+    }
+    return total;
+}
+
+void ThreeDimLife::hashSlabs(int begin, int end) {
+    size_t words = cells.slabWords();
+    for (int z=begin; z<end; ++z) {
+        const uint64_t *slab = cells.slab(z);
+        uint64_t sum = lifeMix64(z + 1);
+        for (size_t n=0; n<words; ++n) {
+            sum = sum*0x9e3779b97f4a7c15ULL + slab[n];
         }
+        slabHashes[z] = lifeMix64(sum);
     }
+}
 
-    for (int i=0; i<h; ++i) {
-        for (int j=0; j<w; ++j) {
-            for (int k=0; k<d; ++k) {
-                int num = countNeighbors(i,j, k);
-
-                if (array[i][j][k]) {
-                    if ((num < 2) || (num > 3)) {
-                        rval[i][j][k] = false;
-                    } else {
-                        rval[i][j][k] = true;
-                    }
-                } else {
-                    if (num == 3) {
-                        rval[i][j][k] = true;
-                    } else {
-                        rval[i][j][k] = false;
-                    }
-                }
+static inline void fullAdd(uint64_t a, uint64_t b, uint64_t c,
+                           uint64_t &sum, uint64_t &carry) {
+    sum = a ^ b ^ c;
+    carry = (a & b) | (c & (a ^ b));
+}
+
+// Sums the three cells around bit n of word k of a row into two bits
+static inline void lineSum(const LifeVolume &vol, const uint64_t *row, int k,
+                           uint64_t &ones, uint64_t &twos) {
+    fullAdd(vol.westWord(row, k), row[k], vol.eastWord(row, k), ones, twos);
+}
+
+void ThreeDimLife::sumPlanes(int begin, int end) {
+    int h = height;
+    int words = cells.words();
+
+    for (int z=begin; z<end; ++z) {
+        uint64_t *sum = &planeSums[4*cells.slabWords()*z];
+        for (int y=0; y<h; ++y) {
+            const uint64_t *up = cells.row(y > 0 ? y-1 : h-1, z);
+            const uint64_t *mid = cells.row(y, z);
+            const uint64_t *down = cells.row(y < h-1 ? y+1 : 0, z);
+
+            for (int k=0; k<words; ++k, sum += 4) {
+                uint64_t u0, u1, m0, m1, d0, d1;
+                lineSum(cells, up, k, u0, u1);
+                lineSum(cells, mid, k, m0, m1);
+                lineSum(cells, down, k, d0, d1);
+
+                // Three 2 bit sums make at most 9
+                uint64_t c0, s1, c1;
+                fullAdd(u0, m0, d0, sum[0], c0);
+                fullAdd(u1, m1, d1, s1, c1);
+                sum[1] = s1 ^ c0;
+                uint64_t c2 = s1 & c0;
+                sum[2] = c1 ^ c2;
+                sum[3] = c1 & c2;
             }
         }
     }
-    array = rval;
-    return false;
+}
+
+void ThreeDimLife::evolveSlabs(int begin, int end) {
+    MooreRule r(rule);
+    int d = depth;
+    int h = height;
+    int words = cells.words();
+    uint64_t last = cells.lastMask();
+    size_t slabSums = 4*cells.slabWords();
+
+    for (int z=begin; z<end; ++z) {
+        const uint64_t *back = &planeSums[slabSums*(z > 0 ? z-1 : d-1)];
+        const uint64_t *mid = &planeSums[slabSums*z];
+        const uint64_t *front = &planeSums[slabSums*(z < d-1 ? z+1 : 0)];
+        const uint64_t *in = cells.slab(z);
+        uint64_t *out = nextCells.slab(z);
+
+        for (int y=0; y<h; ++y) {
+            for (int k=0; k<words; ++k) {
+                // Three 4 bit sums make at most 27
+                uint64_t box[5], c0, s1, c1, c2, s2, c3, c4, s3, c5, c6;
+                fullAdd(back[0], mid[0], front[0], box[0], c0);
+                fullAdd(back[1], mid[1], front[1], s1, c1);
+                box[1] = s1 ^ c0;
+                c2 = s1 & c0;
+                fullAdd(back[2], mid[2], front[2], s2, c3);
+                fullAdd(s2, c1, c2, box[2], c4);
+                fullAdd(back[3], mid[3], front[3], s3, c5);
+                fullAdd(s3, c3, c4, box[3], c6);
+                box[4] = c5 ^ c6;
+
+                *out = r.apply(box, *in);
+                back += 4;
+                mid += 4;
+                front += 4;
+                ++in;
+                ++out;
+            }
+            out[-1] &= last;
+        }
+    }
 }
 
 void ThreeDimLife::draw() {
@@ -239,23 +363,6 @@ void ThreeDimLife::draw() {
     glLoadIdentity();
 
 
-    static GLfloat cubeCorners[] = {0.02f, 0.98f, 0.98f,
-                                     0.98f, 0.98f, 0.98f,
-                                    0.98f, 0.02f, 0.98f,
-                                    0.02f, 0.02f, 0.98f,
-                                    0.02f, 0.98f, 0.02f,
-                                    0.98f, 0.98f, 0.02f,
-                                    0.98f, 0.02f, 0.02f,
-                                    0.02f, 0.02f, 0.02f,
-    };
-    static GLubyte indexes[] = {0, 1, 2, 3,
-                                4, 5, 1, 0,
-                                3, 2, 6, 7,
-                                5, 4, 7, 6,
-                                1, 5, 6, 2,
-                                4, 0, 3, 7,
-    };
-
     glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
     glEnable(GL_BLEND);
     glEnable(GL_POINT_SMOOTH);
@@ -265,59 +372,17 @@ void ThreeDimLife::draw() {
     glEnable(GL_POLYGON_SMOOTH);
     glHint(GL_POLYGON_SMOOTH_HINT, GL_NICEST);
 
-    // glTranslatef(-0.5*width, -0.5*height, 0);
-    float dx = 100.0/width;
-    float dy = 100.0/height;
-    float dz = 100.0/depth;
-    
-    glEnableClientState(GL_VERTEX_ARRAY);
-
     glTranslatef(-0.5*width, -0.5*height, -0.5*depth);
-    // qDebug() << "Drawing";
-    for (int i=0; i < height; ++i) {
-        float cy = i*dy;
-        for (int j=0; j<width; ++j) {
-            float cx = j*dx;
-            
-            for (int k=0;k<depth; ++k) {
-                float cz = k*dz;
-
-                if (array[i][j][k]) {
-                    
-                    // Draw the box
-                    glPushMatrix();
-                    // glScalef(0.25, 0.25, 0.25);
-                    glTranslatef(i,
-                                 j,
-                                 k);
-                    glMaterialfv(GL_FRONT_AND_BACK, GL_DIFFUSE, mat_diffuse[BOX_MAT]);
-                    glMaterialfv(GL_FRONT_AND_BACK, GL_AMBIENT, mat_ambient[BOX_MAT]);
-                    glMaterialfv(GL_FRONT_AND_BACK, GL_SPECULAR, mat_specular[BOX_MAT]);
-                    glMaterialfv(GL_FRONT_AND_BACK, GL_SHININESS, mat_shininess[BOX_MAT]);
-                    glPolygonMode(GL_FRONT_AND_BACK, GL_FILL);
-
-                    glVertexPointer(3, GL_FLOAT, 0, cubeCorners);
-
-                    glDrawElements(GL_QUADS, 24, GL_UNSIGNED_BYTE, indexes);
-    
-                    glLineWidth(1.5);
-
-                    glMaterialfv(GL_FRONT_AND_BACK, GL_DIFFUSE, mat_diffuse[LINE_MAT]);
-                    glMaterialfv(GL_FRONT_AND_BACK, GL_AMBIENT, mat_ambient[LINE_MAT]);
-                    glMaterialfv(GL_FRONT_AND_BACK, GL_SPECULAR, mat_specular[LINE_MAT]);
-                    glMaterialfv(GL_FRONT_AND_BACK, GL_SHININESS, mat_shininess[LINE_MAT]);
-                    
 
-                    glPolygonMode(GL_FRONT_AND_BACK, GL_LINE);// Draw the outline
-                    glVertexPointer(3, GL_FLOAT, 0, cubeCorners);
-                    glDrawElements(GL_QUADS, 24, GL_UNSIGNED_BYTE, indexes);
-    
-                    glLineWidth(1.0);
-                    glPopMatrix();
-                }
-            }
-        }
+    // Moving the camera only calls the list again, the geometry is only
+    // meshed and compiled once per generation
+    if (listStale || listGeneration != generation) {
+        mesh.update(cells, depth);
+        compileMeshList();
+        listGeneration = generation;
+        listStale = false;
     }
+    glCallList(meshList);
 
     // Reset to how we found things
     glPopMatrix();
@@ -329,45 +394,78 @@ void ThreeDimLife::draw() {
     glFlush();
 }
 
+void ThreeDimLife::compileMeshList() {
+    if (!meshList) {
+        meshList = glGenLists(1);
+    }
+    glNewList(meshList, GL_COMPILE);
+    // Every face, then every outline, with the materials set once for each
+    glMaterialfv(GL_FRONT_AND_BACK, GL_DIFFUSE, mat_diffuse[BOX_MAT]);
+    glMaterialfv(GL_FRONT_AND_BACK, GL_AMBIENT, mat_ambient[BOX_MAT]);
+    glMaterialfv(GL_FRONT_AND_BACK, GL_SPECULAR, mat_specular[BOX_MAT]);
+    glMaterialfv(GL_FRONT_AND_BACK, GL_SHININESS, mat_shininess[BOX_MAT]);
+    glPolygonMode(GL_FRONT_AND_BACK, GL_FILL);
+    mesh.draw();
+
+    glLineWidth(1.5);
+    glMaterialfv(GL_FRONT_AND_BACK, GL_DIFFUSE, mat_diffuse[LINE_MAT]);
+    glMaterialfv(GL_FRONT_AND_BACK, GL_AMBIENT, mat_ambient[LINE_MAT]);
+    glMaterialfv(GL_FRONT_AND_BACK, GL_SPECULAR, mat_specular[LINE_MAT]);
+    glMaterialfv(GL_FRONT_AND_BACK, GL_SHININESS, mat_shininess[LINE_MAT]);
+    glPolygonMode(GL_FRONT_AND_BACK, GL_LINE);
+    mesh.draw();
+    glLineWidth(1.0);
+    glPolygonMode(GL_FRONT_AND_BACK, GL_FILL);
+    glEndList();
+}
+
 void ThreeDimLife::reset() {
-    array.clear();
-    array.resize(height);
-    for (int i=0; i<height; ++i) {
-        array[i].resize(width);
-        for (int j=0;j<width; ++j) {
-            array[i][j].resize(depth, false);
-        }
+    cells.resize(width, height, depth);
+    nextCells.resize(width, height, depth);
+    planeSums.assign(4*cells.slabWords()*depth, 0);
+    listStale = true;
+
+    boardSeed = seed ? seed : lifeNewSeed();
+    if (settings) {
+        settings->setValue("three_dim_last_seed", boardSeed);
     }
-    int num = prob*width*height*depth;
-    for (int i=0;i<num; ++i) {
-        size_t ri = randUInt(0, height);
-        size_t rj = randUInt(0, width);
-        size_t rk = randUInt(0, depth);
-        array[ri][rj][rk] = true;
+    LifeBernoulli bits(boardSeed, prob);
+    fillBits = &bits;
+    parallelBands(height, this, &ThreeDimLife::fillRows, 16384/qMax(width*depth, 1) + 1);
+    fillBits = 0;
+
+    generation = 0;
+    slabHashes.assign(depth, 0);
+    history.reset(maxPeriod);
+    if (history.enabled()) {
+        history.record(boardHash(), 0);
     }
     initMaterials();
     initLights();
 }
-int ThreeDimLife::countNeighbors(int i, int j, int k) {
-    int w = width;
-    int h = height;
-
-    int num = 0;
-    int up = i-1>0 ? i-1 : h-1;
-    int down = i+1 <h-1 ? i+1 : 0;
-    int left = j-1>0 ? j-1 : w-1;
-    int right = j+1 < w-1 ? j+1 : 0;
-    
-    num += array[up][j][k];
-    num += array[down][j][k];
-    num += array[i][left][k];
-    num += array[i][right][k];
-    num += array[up][left][k];
-    num += array[up][right][k];
-    num += array[down][left][k];
-    num += array[down][right][k];
+// Each line of cells along k starts a new word of the stream, the way it
+// did before the volume was packed along x, so seeds give the same boards
+void ThreeDimLife::fillRows(int begin, int end) {
+    int words = (depth+63)/64;
+    for (int i=begin; i<end; ++i) {
+        for (int j=0; j<width; ++j) {
+            for (int k=0; k<words; ++k) {
+                uint64_t word = fillBits->word((uint64_t(i)*width + j)*words + k);
+                if (k == words-1 && (depth & 63)) {
+                    word &= (uint64_t(1) << (depth & 63)) - 1;
+                }
+                while (word) {
+                    int n = __builtin_ctzll(word);
+                    word &= word - 1;
+                    cells.set(j, i, 64*k + n, true);
+                }
+            }
+        }
+    }
+}
 
-    return num;
+int ThreeDimLife::bufferAllocations() {
+    return cells.allocations() + nextCells.allocations();
 }
 
 void ThreeDimLife::setRGB(double red, double green, double blue) {
@@ -391,6 +489,35 @@ void ThreeDimLife::getProb(double &probability) {
     probability = prob;
 }
 
+void ThreeDimLife::setRule(const MooreRule &newRule) {
+    rule = newRule;
+}
+void ThreeDimLife::getRule(MooreRule &curRule) {
+    curRule = rule;
+}
+
+void ThreeDimLife::setMaxPeriod(int period) {
+    maxPeriod = period;
+}
+void ThreeDimLife::getMaxPeriod(int &period) {
+    period = maxPeriod;
+}
+
+void ThreeDimLife::setSeed(quint64 newSeed) {
+    seed = newSeed;
+}
+void ThreeDimLife::getSeed(quint64 &curSeed) {
+    curSeed = seed;
+}
+
+void ThreeDimLife::setMergeFaces(bool merge) {
+    mesh.setMerge(merge);
+    listStale = true;
+}
+void ThreeDimLife::getMergeFaces(bool &merge) {
+    merge = mesh.merging();
+}
+
 void ThreeDimLife::setDim(int w, int h, int d) {
     width = w;
     height = h;
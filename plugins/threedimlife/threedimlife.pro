@@ -5,8 +5,8 @@ QT += opengl
 
 CONFIG += debug
 
-HEADERS       = threedimlife.h threedimlifeconfig.h
-SOURCES       = threedimlife.cpp threedimlifeconfig.cpp
+HEADERS       = threedimlife.h threedimlifeconfig.h moorerule.h
+SOURCES       = threedimlife.cpp threedimlifeconfig.cpp moorerule.cpp
 
 DESTDIR       = ../../bin/plugins
 
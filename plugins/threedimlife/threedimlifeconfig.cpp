@@ -71,9 +71,46 @@ ThreeDimLifeConfig::ThreeDimLifeConfig(ThreeDimLife *sl,
     blueEdit = new QLineEdit(tr("%1").arg(b,0,'g', 3));
     layout->addWidget(blueEdit, curRow, 1);
     curRow += 1;
+    MooreRule rule;
+    life->getRule(rule);
+    layout->addWidget(new QLabel(tr("Rule")), curRow, 0);
+    ruleCombo = new QComboBox;
+    ruleCombo->setEditable(true);
+    ruleCombo->addItem("4555");
+    ruleCombo->addItem("5766");
+    ruleCombo->addItem("B4/S5..6");
+    ruleCombo->addItem("B5..7/S4..7");
+    ruleCombo->setEditText(QString::fromLatin1(rule.toString().c_str()));
+    layout->addWidget(ruleCombo, curRow, 1);
+    curRow += 1;
+
+    int maxPeriod;
+    life->getMaxPeriod(maxPeriod);
+    layout->addWidget(new QLabel(tr("Max period")), curRow, 0);
+    periodEdit = new QLineEdit(tr("%1").arg(maxPeriod));
+    layout->addWidget(periodEdit, curRow, 1);
+    curRow += 1;
+
     // QPushButton *colorPicker = new QPushButton("");
     // colorPicker->
         
+    quint64 seed;
+    life->getSeed(seed);
+    layout->addWidget(new QLabel(tr("Seed (0 for a new one each reset)")), curRow, 0);
+    seedEdit = new QLineEdit(tr("%1").arg(seed));
+    layout->addWidget(seedEdit, curRow, 1);
+    curRow += 1;
+
+    bool merge;
+    life->getMergeFaces(merge);
+    layout->addWidget(new QLabel(tr("Faces")), curRow, 0);
+    facesCombo = new QComboBox;
+    facesCombo->addItem(tr("One per cell"), false);
+    facesCombo->addItem(tr("Merged, outlines without cell edges"), true);
+    facesCombo->setCurrentIndex(facesCombo->findData(merge));
+    layout->addWidget(facesCombo, curRow, 1);
+    curRow += 1;
+
     okayButton = new QPushButton(tr("Okay"));
     layout->addWidget(okayButton, curRow, 0);
     connect(okayButton, SIGNAL(clicked()), this, SLOT(finish()));
@@ -90,21 +127,40 @@ void ThreeDimLifeConfig::finish() {
     int newWidth = widthEdit->text().toInt();
     int newHeight = heightEdit->text().toInt();
     int newDepth = depthEdit->text().toInt();
+    if (newWidth < 1 || newHeight < 1 || newDepth < 1) {
+        QMessageBox::warning(this, tr("3D Life"),
+                             tr("The board has to be at least 1x1x1."));
+        return;
+    }
 
     double newProb = probEdit->text().toDouble();
     double newRed = redEdit->text().toDouble();
     double newGreen = greenEdit->text().toDouble();
     double newBlue = blueEdit->text().toDouble();
+    quint64 newSeed = seedEdit->text().toULongLong();
+    bool newMerge = facesCombo->itemData(facesCombo->currentIndex()).toBool();
+    int newMaxPeriod = periodEdit->text().toInt();
+
+    MooreRule newRule;
+    if (!newRule.parse(ruleCombo->currentText().toLatin1().constData())) {
+        QMessageBox::warning(this, tr("3D Life"),
+                             tr("\"%1\" is not a rule like 4555 or B5/S4,5.").arg(ruleCombo->currentText()));
+        return;
+    }
 
     if (settings) {
         settings->setValue("three_dim_width", newWidth);
         settings->setValue("three_dim_height", newHeight);
         settings->setValue("three_dim_depth", newDepth);
         settings->setValue("three_dim_initial_fill", newProb);
+        settings->setValue("three_dim_moore_rule", QString::fromLatin1(newRule.toString().c_str()));
+        settings->setValue("three_dim_max_period", newMaxPeriod);
 
         settings->value("three_dim_red", newRed);
         settings->value("three_dim_green", newGreen);
         settings->value("three_dim_blue", newBlue);
+        settings->setValue("three_dim_seed", newSeed);
+        settings->setValue("three_dim_merge_faces", newMerge);
 
         settings->sync();
     }
@@ -112,6 +168,10 @@ void ThreeDimLifeConfig::finish() {
     life->setDim(newWidth, newHeight, newDepth);
     life->setProb(newProb);
     life->setRGB(newRed, newGreen, newBlue);
+    life->setRule(newRule);
+    life->setMaxPeriod(newMaxPeriod);
+    life->setSeed(newSeed);
+    life->setMergeFaces(newMerge);
 
     this->close();
 
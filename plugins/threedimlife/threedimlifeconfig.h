@@ -26,6 +26,7 @@
 class QPushButton;
 class QLineEdit;
 class QLabel;
+class QComboBox;
 class QSettings;
 
 class ThreeDimLifeConfig : public QDialog {
@@ -47,6 +48,12 @@ private:
     QLineEdit *greenEdit;
     QLineEdit *blueEdit;
 
+    QLineEdit *seedEdit;
+    QComboBox *facesCombo;
+
+    QComboBox *ruleCombo;
+    QLineEdit *periodEdit;
+
     QPushButton *okayButton;
     QPushButton *cancelButton;
 
@@ -0,0 +1,57 @@
+/*
+  lifebits.h
+
+  Copyright (c) 2011, Jeremiah LaRocco jeremiah.larocco@gmail.com
+
+  Permission to use, copy, modify, and/or distribute this software for any
+  purpose with or without fee is hereby granted, provided that the above
+  copyright notice and this permission notice appear in all copies.
+
+  THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+  WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+  MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+  ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+  WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+  ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+  OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+
+#ifndef LIFE_BITS_H
+#define LIFE_BITS_H
+
+#include <stdint.h>
+
+#include "liferule.h"
+
+/*
+  Computes the next state of 64 cells at once.  Each argument holds the
+  neighbors in one direction, already shifted so that bit n of every word
+  lines up with bit n of the center word m.  The eight neighbors are summed
+  with a bit-sliced adder and the rule is applied to the bits of the count.
+*/
+template <class Rule>
+inline uint64_t ruleWord(const Rule &rule,
+                         uint64_t uw, uint64_t u, uint64_t ue,
+                         uint64_t mw, uint64_t m, uint64_t me,
+                         uint64_t dw, uint64_t d, uint64_t de) {
+    // Full adders for the rows above and below, half adder for the middle
+    uint64_t upSum = uw ^ u ^ ue;
+    uint64_t upCarry = (uw & u) | (ue & (uw ^ u));
+    uint64_t downSum = dw ^ d ^ de;
+    uint64_t downCarry = (dw & d) | (de & (dw ^ d));
+    uint64_t midSum = mw ^ me;
+    uint64_t midCarry = mw & me;
+
+    uint64_t ones = upSum ^ downSum ^ midSum;
+    uint64_t onesCarry = (upSum & downSum) | (midSum & (upSum ^ downSum));
+
+    uint64_t t = upCarry ^ downCarry ^ midCarry;
+    uint64_t tCarry = (upCarry & downCarry) | (midCarry & (upCarry ^ downCarry));
+    uint64_t twos = t ^ onesCarry;
+    uint64_t fours = tCarry ^ (t & onesCarry);
+    uint64_t eights = tCarry & t & onesCarry;
+
+    return rule.apply(ones, twos, fours, eights, m);
+}
+
+#endif
@@ -0,0 +1,155 @@
+/*
+  lifeengine.cpp
+  
+  Copyright (c) 2011, Jeremiah LaRocco jeremiah.larocco@gmail.com
+
+  Permission to use, copy, modify, and/or distribute this software for any
+  purpose with or without fee is hereby granted, provided that the above
+  copyright notice and this permission notice appear in all copies.
+
+  THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+  WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+  MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+  ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+  WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+  ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+  OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+
+#include <QTime>
+#include <QElapsedTimer>
+
+#include "lifeengine.h"
+
+LifeEngine::LifeEngine(QObject *parent) : QThread(parent),
+                                          plugin(0),
+                                          running(false),
+                                          quitting(false),
+                                          frameWanted(false),
+                                          genRate(0),
+                                          generations(0),
+                                          evolveMs(0) {
+}
+
+LifeEngine::~LifeEngine() {
+    stateLock.lock();
+    quitting = true;
+    wake.wakeAll();
+    stateLock.unlock();
+    wait();
+}
+
+void LifeEngine::setPlugin(LifePlugin *newPlugin) {
+    QMutexLocker locker(&stateLock);
+    plugin = newPlugin;
+    generations = 0;
+    evolveMs = 0;
+}
+
+void LifeEngine::setRate(int gensPerSecond) {
+    QMutexLocker locker(&stateLock);
+    genRate = qMax(gensPerSecond, 0);
+    wake.wakeAll();
+}
+
+int LifeEngine::rate() {
+    QMutexLocker locker(&stateLock);
+    return genRate;
+}
+
+bool LifeEngine::evolving() {
+    QMutexLocker locker(&stateLock);
+    return running;
+}
+
+double LifeEngine::evolveMillis() {
+    QMutexLocker locker(&stateLock);
+    return evolveMs;
+}
+
+qint64 LifeEngine::takeGenerations() {
+    QMutexLocker locker(&stateLock);
+    qint64 gens = generations;
+    generations = 0;
+    return gens;
+}
+
+void LifeEngine::requestFrame() {
+    QMutexLocker locker(&stateLock);
+    frameWanted = true;
+    wake.wakeAll();
+}
+
+void LifeEngine::frameDone() {
+    QMutexLocker locker(&stateLock);
+    frameWanted = false;
+    wake.wakeAll();
+}
+
+void LifeEngine::resume() {
+    QMutexLocker locker(&stateLock);
+    running = true;
+    wake.wakeAll();
+}
+
+void LifeEngine::pause() {
+    QMutexLocker locker(&stateLock);
+    running = false;
+}
+
+void LifeEngine::run() {
+    QMutexLocker locker(&stateLock);
+
+    // Generations are paced from when the engine last started or the rate
+    // last changed, so a late frame doesn't slow down the ones after it
+    QTime clock;
+    int paced = -1;
+    int pacedRate = 0;
+    QElapsedTimer evolveClock;
+
+    while (!quitting) {
+        if (frameWanted) {
+            emit frameReady();
+            while (frameWanted && !quitting) {
+                wake.wait(&stateLock);
+            }
+            continue;
+        }
+        if (!running || !plugin) {
+            paced = -1;
+            wake.wait(&stateLock);
+            continue;
+        }
+        if (paced < 0 || pacedRate != genRate) {
+            clock.start();
+            paced = 0;
+            pacedRate = genRate;
+        }
+        if (genRate > 0) {
+            int due = int(qint64(paced)*1000/genRate) - clock.elapsed();
+            if (due > 0) {
+                wake.wait(&stateLock, due);
+                continue;
+            }
+        }
+
+        // The plugin only changes while pluginLock is held
+        locker.unlock();
+        pluginLock.lock();
+        evolveClock.start();
+        bool done = plugin->evolve();
+        qint64 nsecs = evolveClock.nsecsElapsed();
+        qint64 stepGens = plugin->generationsPerStep();
+        pluginLock.unlock();
+        locker.relock();
+
+        // Smoothed over the last few dozen generations
+        evolveMs += (nsecs*1e-6 - evolveMs)/32;
+        generations += stepGens;
+        ++paced;
+        if (done) {
+            running = false;
+            emit stopped();
+        }
+    }
+}
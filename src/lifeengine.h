@@ -0,0 +1,90 @@
+/*
+  lifeengine.h
+  
+  Copyright (c) 2011, Jeremiah LaRocco jeremiah.larocco@gmail.com
+
+  Permission to use, copy, modify, and/or distribute this software for any
+  purpose with or without fee is hereby granted, provided that the above
+  copyright notice and this permission notice appear in all copies.
+
+  THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+  WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+  MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+  ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+  WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+  ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+  OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+
+#ifndef LIFE_ENGINE_INCLUDE_H
+#define LIFE_ENGINE_INCLUDE_H
+
+#include <QThread>
+#include <QMutex>
+#include <QWaitCondition>
+
+#include "lifeplugin.h"
+
+/*
+  Evolves the current plugin on its own thread, as fast as the CPU allows
+  or at a target number of generations per second.  The engine holds
+  pluginMutex() while evolve() runs, and anything else touching the plugin
+  must hold it too.  To draw, the widget asks for a frame and the engine
+  stops between generations and emits frameReady(), so every frame shows
+  a completed generation; it carries on once frameDone() is called.
+*/
+class LifeEngine : public QThread {
+    Q_OBJECT;
+
+public:
+    LifeEngine(QObject *parent = 0);
+    ~LifeEngine();
+
+    QMutex *pluginMutex() { return &pluginLock; }
+
+    // Only while holding pluginMutex()
+    void setPlugin(LifePlugin *newPlugin);
+
+    // Generations per second, 0 for as fast as possible
+    void setRate(int gensPerSecond);
+    int rate();
+
+    bool evolving();
+
+    // Recent average time evolve() takes
+    double evolveMillis();
+
+    // Generations evolved since the last call
+    qint64 takeGenerations();
+
+    void requestFrame();
+    void frameDone();
+
+public slots:
+    void resume();
+    void pause();
+
+signals:
+    void frameReady();
+    // Emitted when evolve() returned true and the engine paused itself
+    void stopped();
+
+protected:
+    void run();
+
+private:
+    LifePlugin *plugin;
+    QMutex pluginLock;
+
+    // Guards everything below
+    QMutex stateLock;
+    QWaitCondition wake;
+    bool running;
+    bool quitting;
+    bool frameWanted;
+    int genRate;
+    qint64 generations;
+    double evolveMs;
+};
+
+#endif
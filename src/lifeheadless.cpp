@@ -0,0 +1,189 @@
+/*
+  lifeheadless.cpp
+  
+  Copyright (c) 2011, Jeremiah LaRocco jeremiah.larocco@gmail.com
+
+  Permission to use, copy, modify, and/or distribute this software for any
+  purpose with or without fee is hereby granted, provided that the above
+  copyright notice and this permission notice appear in all copies.
+
+  THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+  WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+  MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+  ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+  WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+  ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+  OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+
+#include <QtCore>
+#include <iostream>
+
+#include "lifeplugin.h"
+#include "lifeheadless.h"
+
+static void usage() {
+    std::cerr << "Usage: qlife --headless [--plugin name] [--generations n] [--report n]\n"
+                 "                        [--threads n] [--set key=value ...] [--list]\n"
+                 "  --plugin       plugin to run, by name (default: the first one)\n"
+                 "  --generations  most generations to run, stops early once stable (default 1000)\n"
+                 "  --report       print a line every n generations (default 0, only at the end)\n"
+                 "  --threads      worker threads (default: the worker_threads setting)\n"
+                 "  --set          override a setting, like --set simple_width=4096\n"
+                 "  --list         list the plugins and exit\n";
+}
+
+static void print(const QString &line) {
+    std::cout << line.toLocal8Bit().constData() << std::endl;
+}
+
+static QString populationText(LifePlugin *plugin) {
+    double pop = plugin->population();
+    return pop < 0 ? QObject::tr("unknown") : QString::number(pop, 'f', 0);
+}
+
+int runHeadless() {
+    QStringList args = QCoreApplication::arguments();
+
+    QString pluginName;
+    qint64 generations = 1000;
+    qint64 report = 0;
+    int threads = 0;
+    bool list = false;
+    QStringList sets;
+
+    for (int i=1; i<args.size(); ++i) {
+        QString arg = args[i];
+        bool hasValue = i+1 < args.size();
+        bool ok = true;
+        if (arg == "--headless") {
+            continue;
+        } else if (arg == "--list") {
+            list = true;
+        } else if (arg == "--plugin" && hasValue) {
+            pluginName = args[++i];
+        } else if (arg == "--generations" && hasValue) {
+            generations = args[++i].toLongLong(&ok);
+            ok = ok && generations >= 0;
+        } else if (arg == "--report" && hasValue) {
+            report = args[++i].toLongLong(&ok);
+            ok = ok && report >= 0;
+        } else if (arg == "--threads" && hasValue) {
+            threads = args[++i].toInt(&ok);
+            ok = ok && threads > 0;
+        } else if (arg == "--set" && hasValue) {
+            sets << args[++i];
+            ok = sets.last().contains('=');
+        } else {
+            ok = false;
+        }
+        if (!ok) {
+            usage();
+            return 2;
+        }
+    }
+
+    // A scratch copy of the user's settings, so plugins can write to it
+    QSettings user(QSettings::IniFormat, QSettings::UserScope, "Life", "Life");
+    QTemporaryFile scratch;
+    if (!scratch.open()) {
+        std::cerr << "Couldn't create a temporary settings file" << std::endl;
+        return 1;
+    }
+    QSettings settings(scratch.fileName(), QSettings::IniFormat);
+    foreach (QString key, user.allKeys()) {
+        settings.setValue(key, user.value(key));
+    }
+    foreach (QString set, sets) {
+        int eq = set.indexOf('=');
+        settings.setValue(set.left(eq), set.mid(eq+1));
+    }
+
+    QThreadPool::globalInstance()->setExpiryTimeout(-1);
+    QThreadPool::globalInstance()->setMaxThreadCount(
+        threads ? threads : settings.value("worker_threads", QThread::idealThreadCount()).toInt());
+
+    QDir pluginDir(QCoreApplication::applicationDirPath());
+    if (!pluginDir.cd("plugins")) {
+        std::cerr << "No plugins directory next to " << args[0].toLocal8Bit().constData() << std::endl;
+        return 1;
+    }
+    LifePlugin *plugin = 0;
+    foreach (QString fileName, pluginDir.entryList(QDir::Files)) {
+        QPluginLoader loader(pluginDir.absoluteFilePath(fileName));
+        LifePlugin *found = qobject_cast<LifePlugin *>(loader.instance());
+        if (!found) {
+            continue;
+        }
+        if (list) {
+            print(QString("%1: %2").arg(found->name()).arg(found->description()));
+        } else if (!plugin && (pluginName.isEmpty() ||
+                               found->name().compare(pluginName, Qt::CaseInsensitive) == 0)) {
+            plugin = found;
+        }
+    }
+    if (list) {
+        return 0;
+    }
+    if (!plugin) {
+        std::cerr << "No plugin named \"" << pluginName.toLocal8Bit().constData() << "\"" << std::endl;
+        return 1;
+    }
+
+    // Fills the board too
+    QElapsedTimer clock;
+    clock.start();
+    plugin->readSettings(&settings);
+    double setupSecs = clock.nsecsElapsed()*1e-9;
+
+    print(QObject::tr("%1: %2").arg(plugin->name()).arg(plugin->engineInfo()));
+    print(QObject::tr("Generation 0, population %1, set up in %2 s")
+          .arg(populationText(plugin))
+          .arg(setupSecs, 0, 'f', 3));
+
+    // Plugins can evolve several generations a step, so gen can go past
+    // generations and past a multiple of report without landing on it
+    qint64 gen = 0;
+    qint64 steps = 0;
+    bool stable = false;
+    // Counted from after the first step, which may still set up lookup
+    // tables and the like
+    int allocs = -1;
+    clock.restart();
+    while (gen < generations && !stable) {
+        qint64 last = gen;
+        stable = plugin->evolve();
+        gen += plugin->generationsPerStep();
+        ++steps;
+        if (steps == 1) {
+            allocs = plugin->bufferAllocations();
+        }
+        if (report && gen/report != last/report) {
+            double secs = clock.nsecsElapsed()*1e-9;
+            print(QObject::tr("Generation %1, population %2, %3 gen/s")
+                  .arg(gen)
+                  .arg(populationText(plugin))
+                  .arg(gen/secs, 0, 'f', 1));
+        }
+    }
+    double secs = clock.nsecsElapsed()*1e-9;
+
+    print(QObject::tr("%1 generations in %2 s, %3 gen/s, %4 ms per generation%5")
+          .arg(gen)
+          .arg(secs, 0, 'f', 3)
+          .arg(gen ? gen/secs : 0, 0, 'f', 1)
+          .arg(gen ? 1000*secs/gen : 0, 0, 'f', 3)
+          .arg(stable ? QObject::tr(", stopped once stable") : QString()));
+    print(QObject::tr("Generation %1, population %2").arg(gen).arg(populationText(plugin)));
+    print(QObject::tr("%1: %2").arg(plugin->name()).arg(plugin->engineInfo()));
+
+    if (allocs >= 0) {
+        int evolveAllocs = plugin->bufferAllocations() - allocs;
+        print(QObject::tr("%1 buffer allocations after the first step").arg(evolveAllocs));
+        if (evolveAllocs != 0) {
+            std::cerr << "evolve() allocated cell buffers" << std::endl;
+            return 1;
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,35 @@
+/*
+  lifeheadless.h
+  
+  Copyright (c) 2011, Jeremiah LaRocco jeremiah.larocco@gmail.com
+
+  Permission to use, copy, modify, and/or distribute this software for any
+  purpose with or without fee is hereby granted, provided that the above
+  copyright notice and this permission notice appear in all copies.
+
+  THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+  WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+  MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+  ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+  WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+  ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+  OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+
+#ifndef LIFE_HEADLESS_INCLUDE_H
+#define LIFE_HEADLESS_INCLUDE_H
+
+/*
+  Runs a plugin's engine from the command line, without a window or GL:
+
+    qlife --headless [--plugin name] [--generations n] [--report n]
+                     [--threads n] [--set key=value ...] [--list]
+
+  Only readSettings(), reset(), evolve(), engineInfo() and population()
+  are called, never initView() or draw().  Settings start from a copy of
+  the user's, with --set applied on top, so nothing is saved back.
+  Needs a QCoreApplication.
+*/
+int runHeadless();
+
+#endif
@@ -0,0 +1,86 @@
+/*
+  lifehistory.h
+
+  Copyright (c) 2011, Jeremiah LaRocco jeremiah.larocco@gmail.com
+
+  Permission to use, copy, modify, and/or distribute this software for any
+  purpose with or without fee is hereby granted, provided that the above
+  copyright notice and this permission notice appear in all copies.
+
+  THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+  WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+  MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+  ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+  WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+  ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+  OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+
+#ifndef LIFE_HISTORY_H
+#define LIFE_HISTORY_H
+
+#include <vector>
+#include <stdint.h>
+
+#include "liferandom.h"
+
+/*
+  Spots boards that repeat.  Plugins hash the board after each generation
+  and pass it to record(), which keeps the last maxPeriod hashes in a
+  ring.  A match means the board has become a still life (period 1) or an
+  oscillator; anything with a longer period, like a glider crossing the
+  torus, isn't caught.
+*/
+class LifeHistory {
+public:
+    LifeHistory() : maxPer(0), head(0), count(0), per(0), start(0) {}
+
+    // Forgets everything; a maxPeriod of 0 turns detection off
+    void reset(int maxPeriod) {
+        maxPer = maxPeriod > 0 ? maxPeriod : 0;
+        hashes.assign(maxPer, 0);
+        gens.assign(maxPer, 0);
+        head = count = 0;
+        per = 0;
+        start = 0;
+    }
+
+    bool enabled() const { return maxPer > 0; }
+    int maxPeriod() const { return maxPer; }
+
+    // True the first time hash matches one of the last maxPeriod boards
+    bool record(uint64_t hash, uint64_t generation) {
+        if (maxPer == 0 || per != 0) {
+            return false;
+        }
+        for (int n=0; n<count; ++n) {
+            if (hashes[n] == hash) {
+                per = int(generation - gens[n]);
+                start = gens[n];
+                return true;
+            }
+        }
+        hashes[head] = hash;
+        gens[head] = generation;
+        head = (head+1) % maxPer;
+        if (count < maxPer) {
+            ++count;
+        }
+        return false;
+    }
+
+    bool found() const { return per != 0; }
+    int period() const { return per; }
+    // First generation of the repeating cycle
+    uint64_t foundAt() const { return start; }
+
+private:
+    int maxPer;
+    std::vector<uint64_t> hashes;
+    std::vector<uint64_t> gens;
+    int head, count;
+    int per;
+    uint64_t start;
+};
+
+#endif
@@ -0,0 +1,283 @@
+/*
+  lifemesh.h
+  
+  Copyright (c) 2011, Jeremiah LaRocco jeremiah.larocco@gmail.com
+
+  Permission to use, copy, modify, and/or distribute this software for any
+  purpose with or without fee is hereby granted, provided that the above
+  copyright notice and this permission notice appear in all copies.
+
+  THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+  WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+  MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+  ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+  WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+  ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+  OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+
+#ifndef LIFE_MESH_H
+#define LIFE_MESH_H
+
+#include <vector>
+#include <string.h>
+
+#ifdef __APPLE_CC__
+#include <OpenGL/gl.h>
+#else
+#include <GL/gl.h>
+#endif
+
+#include "lifevolume.h"
+
+/*
+  The surface of the live cells of a LifeVolume as one vertex array of
+  quads.  Only faces between a live cell and a dead one are kept, and with
+  merging on, neighboring faces in the same plane become one larger quad:
+  runs along x and then rows along y for faces across z, runs along x for
+  faces across y and runs along y for faces across x.  Quads never span
+  slabs, so update() compares each slab with the one it meshed last time
+  and only meshes the changed slabs and the ones on either side again.
+
+  Drawing the whole volume is a single glDrawArrays() call.  Plugins set
+  their materials and polygon mode once, then call draw() for the filled
+  faces and again for the outlines.
+
+  Cell (x, y, z) is drawn at (y, x, z), which is where the 3D plugins have
+  always put cell (i, j, k).
+*/
+class LifeMesh {
+public:
+    LifeMesh() : merge(false), stale(true), numSlabs(0),
+                 lastWidth(0), lastHeight(0), rebuilt(0) {}
+
+    // Merges coplanar faces into larger quads, remeshing everything
+    void setMerge(bool mergeFaces) {
+        if (merge != mergeFaces) {
+            merge = mergeFaces;
+            stale = true;
+        }
+    }
+    bool merging() const { return merge; }
+
+    // Meshes slabs [0, slabs) of vol; cells outside of them count as dead
+    void update(const LifeVolume &vol, int slabs) {
+        size_t words = vol.slabWords();
+        if (vol.width() != lastWidth || vol.height() != lastHeight || slabs < numSlabs) {
+            stale = true;
+        }
+        if (stale) {
+            lastWidth = vol.width();
+            lastHeight = vol.height();
+            numSlabs = 0;
+            meshed.clear();
+            slabVertices.clear();
+        }
+        // New slabs start out empty, so they only count as changed if they
+        // have live cells
+        if (slabs > numSlabs) {
+            numSlabs = slabs;
+            meshed.resize(words*slabs, 0);
+            slabVertices.resize(slabs);
+        }
+
+        changed.assign(slabs, stale ? 1 : 0);
+        for (int z=0; z<slabs && !stale; ++z) {
+            changed[z] = memcmp(vol.slab(z), &meshed[words*z], words*sizeof(uint64_t)) != 0;
+        }
+
+        rebuilt = 0;
+        bool any = false;
+        for (int z=0; z<slabs; ++z) {
+            bool dirty = changed[z] || (z > 0 && changed[z-1]) || (z < slabs-1 && changed[z+1]);
+            if (dirty) {
+                meshSlab(vol, z, slabs);
+                ++rebuilt;
+                any = true;
+            }
+        }
+        for (int z=0; z<slabs; ++z) {
+            if (changed[z]) {
+                memcpy(&meshed[words*z], vol.slab(z), words*sizeof(uint64_t));
+            }
+        }
+        stale = false;
+
+        if (any) {
+            vertices.clear();
+            for (int z=0; z<slabs; ++z) {
+                vertices.insert(vertices.end(), slabVertices[z].begin(), slabVertices[z].end());
+            }
+        }
+    }
+
+    int quads() const { return int(vertices.size()/12); }
+    // Slabs meshed by the last update()
+    int slabsRebuilt() const { return rebuilt; }
+
+    void draw() const {
+        if (vertices.empty()) {
+            return;
+        }
+        glEnableClientState(GL_VERTEX_ARRAY);
+        glVertexPointer(3, GL_FLOAT, 0, &vertices[0]);
+        glDrawArrays(GL_QUADS, 0, GLsizei(vertices.size()/3));
+        glDisableClientState(GL_VERTEX_ARRAY);
+    }
+
+private:
+    enum Side { West, East, North, South, Back, Front };
+
+    void meshSlab(const LifeVolume &vol, int z, int slabs) {
+        int h = vol.height();
+        int words = vol.words();
+        size_t size = vol.slabWords();
+        for (int s=0; s<6; ++s) {
+            faces[s].resize(size);
+        }
+
+        // Live cells whose neighbor on each side is dead or outside the volume
+        for (int y=0; y<h; ++y) {
+            const uint64_t *row = vol.row(y, z);
+            const uint64_t *up = y > 0 ? vol.row(y-1, z) : 0;
+            const uint64_t *down = y < h-1 ? vol.row(y+1, z) : 0;
+            const uint64_t *back = z > 0 ? vol.row(y, z-1) : 0;
+            const uint64_t *front = z < slabs-1 ? vol.row(y, z+1) : 0;
+            for (int k=0; k<words; ++k) {
+                uint64_t live = row[k];
+                uint64_t west = (live << 1) | (k > 0 ? row[k-1] >> 63 : 0);
+                uint64_t east = (live >> 1) | (k < words-1 ? row[k+1] << 63 : 0);
+                size_t n = size_t(y)*words + k;
+                faces[West][n] = live & ~west;
+                faces[East][n] = live & ~east;
+                faces[North][n] = live & ~(up ? up[k] : 0);
+                faces[South][n] = live & ~(down ? down[k] : 0);
+                faces[Back][n] = live & ~(back ? back[k] : 0);
+                faces[Front][n] = live & ~(front ? front[k] : 0);
+            }
+        }
+
+        std::vector<GLfloat> &out = slabVertices[z];
+        out.clear();
+        mergeFaces(faces[West], West, z, h, words, false, merge, out);
+        mergeFaces(faces[East], East, z, h, words, false, merge, out);
+        mergeFaces(faces[North], North, z, h, words, merge, false, out);
+        mergeFaces(faces[South], South, z, h, words, merge, false, out);
+        mergeFaces(faces[Back], Back, z, h, words, merge, merge, out);
+        mergeFaces(faces[Front], Front, z, h, words, merge, merge, out);
+    }
+
+    // Bits [x0, x1) of a row, one word at a time
+    static uint64_t runBits(int k, int x0, int x1) {
+        int lo = qMax(x0 - 64*k, 0);
+        int hi = qMin(x1 - 64*k, 64);
+        if (lo >= hi) {
+            return 0;
+        }
+        uint64_t upper = hi == 64 ? ~uint64_t(0) : (uint64_t(1) << hi) - 1;
+        return upper & ~((uint64_t(1) << lo) - 1);
+    }
+
+    // Takes rectangles of set bits out of mask, widening them along x and
+    // growing them down along y when allowed, and emits a quad for each
+    static void mergeFaces(std::vector<uint64_t> &mask, Side side, int z, int h, int words,
+                           bool alongX, bool alongY, std::vector<GLfloat> &out) {
+        for (int y=0; y<h; ++y) {
+            uint64_t *row = &mask[size_t(y)*words];
+            for (int k=0; k<words; ++k) {
+                while (row[k]) {
+                    int x0 = 64*k + __builtin_ctzll(row[k]);
+                    int x1 = x0 + 1;
+                    if (alongX) {
+                        int kk = k;
+                        uint64_t rest = ~(row[kk] >> (x0 & 63));
+                        int len = rest ? __builtin_ctzll(rest) : 64 - (x0 & 63);
+                        x1 = x0 + len;
+                        while ((x1 & 63) == 0 && ++kk < words) {
+                            uint64_t ones = ~row[kk];
+                            int more = ones ? __builtin_ctzll(ones) : 64;
+                            x1 += more;
+                            if (more < 64) {
+                                break;
+                            }
+                        }
+                    }
+                    for (int kk=x0>>6; kk<=(x1-1)>>6; ++kk) {
+                        row[kk] &= ~runBits(kk, x0, x1);
+                    }
+
+                    int y1 = y + 1;
+                    while (alongY && y1 < h) {
+                        uint64_t *next = &mask[size_t(y1)*words];
+                        bool full = true;
+                        for (int kk=x0>>6; kk<=(x1-1)>>6 && full; ++kk) {
+                            uint64_t bits = runBits(kk, x0, x1);
+                            full = (next[kk] & bits) == bits;
+                        }
+                        if (!full) {
+                            break;
+                        }
+                        for (int kk=x0>>6; kk<=(x1-1)>>6; ++kk) {
+                            next[kk] &= ~runBits(kk, x0, x1);
+                        }
+                        ++y1;
+                    }
+                    addQuad(side, x0, x1, y, y1, z, out);
+                }
+            }
+        }
+    }
+
+    static void addVertex(GLfloat a, GLfloat b, GLfloat c, std::vector<GLfloat> &out) {
+        out.push_back(a);
+        out.push_back(b);
+        out.push_back(c);
+    }
+
+    // The face on one side of cells [x0, x1) x [y0, y1) of slab z
+    static void addQuad(Side side, int x0, int x1, int y0, int y1, int z,
+                        std::vector<GLfloat> &out) {
+        GLfloat x = GLfloat(side == East ? x1 : x0);
+        GLfloat y = GLfloat(side == South ? y1 : y0);
+        GLfloat zz = GLfloat(side == Front ? z+1 : z);
+        switch (side) {
+        case West:
+        case East:
+            addVertex(y0, x, z, out);
+            addVertex(y1, x, z, out);
+            addVertex(y1, x, z+1, out);
+            addVertex(y0, x, z+1, out);
+            break;
+        case North:
+        case South:
+            addVertex(y, x0, z, out);
+            addVertex(y, x1, z, out);
+            addVertex(y, x1, z+1, out);
+            addVertex(y, x0, z+1, out);
+            break;
+        case Back:
+        case Front:
+            addVertex(y0, x0, zz, out);
+            addVertex(y1, x0, zz, out);
+            addVertex(y1, x1, zz, out);
+            addVertex(y0, x1, zz, out);
+            break;
+        }
+    }
+
+    bool merge;
+    bool stale;
+    int numSlabs;
+    int lastWidth, lastHeight;
+    int rebuilt;
+
+    // Cells as of the last update(), and which slabs differ from them
+    std::vector<uint64_t> meshed;
+    std::vector<unsigned char> changed;
+
+    std::vector<uint64_t> faces[6];
+    std::vector< std::vector<GLfloat> > slabVertices;
+    std::vector<GLfloat> vertices;
+};
+
+#endif
@@ -0,0 +1,103 @@
+/*
+  lifeparallel.h
+
+  Copyright (c) 2011, Jeremiah LaRocco jeremiah.larocco@gmail.com
+
+  Permission to use, copy, modify, and/or distribute this software for any
+  purpose with or without fee is hereby granted, provided that the above
+  copyright notice and this permission notice appear in all copies.
+
+  THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+  WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+  MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+  ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+  WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+  ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+  OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+
+#ifndef LIFE_PARALLEL_H
+#define LIFE_PARALLEL_H
+
+#include <QRunnable>
+#include <QSemaphore>
+#include <QThreadPool>
+
+/*
+  Plugins split their boards into bands of rows (or slabs of voxels) and
+  evolve them on Qt's global thread pool.  The pool is shared by the
+  application and every plugin, its threads are created once and kept
+  around, and LifeWindow sets its size from the "worker_threads" setting.
+*/
+
+static const int MAX_LIFE_BANDS = 256;
+
+template <class Fn>
+class LifeBand : public QRunnable {
+public:
+    LifeBand() : fn(0), begin(0), end(0), done(0) {
+        setAutoDelete(false);
+    }
+
+    void run() {
+        (*fn)(begin, end);
+        done->release();
+    }
+
+    Fn *fn;
+    int begin, end;
+    QSemaphore *done;
+};
+
+/*
+  Calls fn(begin, end) over [0, count) in bands of at least minBand items,
+  one band per pool thread.  The calling thread evolves the first band and
+  the call returns once every band is finished, so it doubles as the
+  barrier at the end of a generation.
+*/
+template <class Fn>
+void parallelBands(int count, Fn &fn, int minBand = 1) {
+    QThreadPool *pool = QThreadPool::globalInstance();
+
+    int bands = qMin(pool->maxThreadCount(), MAX_LIFE_BANDS);
+    bands = qMin(bands, count/qMax(minBand, 1));
+    if (bands <= 1) {
+        fn(0, count);
+        return;
+    }
+
+    LifeBand<Fn> tasks[MAX_LIFE_BANDS];
+    QSemaphore done;
+    for (int b=1; b<bands; ++b) {
+        tasks[b].fn = &fn;
+        tasks[b].begin = int((qint64(count)*b)/bands);
+        tasks[b].end = int((qint64(count)*(b+1))/bands);
+        tasks[b].done = &done;
+        // Never wait on a pool that is already busy, just do the work here
+        if (!pool->tryStart(&tasks[b])) {
+            tasks[b].run();
+        }
+    }
+    fn(0, int(count/bands));
+    done.acquire(bands-1);
+}
+
+template <class T>
+class LifeMemberBand {
+public:
+    LifeMemberBand(T *o, void (T::*f)(int, int)) : obj(o), fn(f) {}
+    void operator()(int begin, int end) { (obj->*fn)(begin, end); }
+
+private:
+    T *obj;
+    void (T::*fn)(int, int);
+};
+
+// Runs obj->fn(begin, end) in bands, for plugins that evolve a range of rows
+template <class T>
+void parallelBands(int count, T *obj, void (T::*fn)(int, int), int minBand = 1) {
+    LifeMemberBand<T> band(obj, fn);
+    parallelBands(count, band, minBand);
+}
+
+#endif
@@ -30,8 +30,13 @@ public:
 
     virtual bool allowViewManipulation()=0;
     virtual void initView()=0;
+    // Frees what initView() and draw() made in the GL context, which is
+    // current; initView() is called again before the next draw()
+    virtual void releaseView() {};
     virtual void resizeView(int width, int height)=0;
     virtual bool evolve()=0;
+    // Generations one call to evolve() advances
+    virtual qint64 generationsPerStep() { return 1; };
     virtual void draw()=0;
     virtual void reset()=0;
     virtual void readSettings(QSettings *sets) = 0;
@@ -39,9 +44,21 @@ public:
 
     virtual void zoom(double) {};
     virtual void rotate(double, double, double) {};
+    // Mouse drags, as fractions of the widget's width and height
+    virtual void pan(double, double) {};
+
+    // Short description of the code path evolve() runs, for the status bar
+    virtual QString engineInfo() { return QString(); };
+
+    // Live cells, or less than 0 if the plugin can't count them
+    virtual double population() { return -1; };
+
+    // Cell buffers allocated so far, or less than 0 if the plugin doesn't
+    // track them; the headless runner checks evolve() leaves this alone
+    virtual int bufferAllocations() { return -1; };
     
 };
 
-Q_DECLARE_INTERFACE(LifePlugin, "com.jlarocco.LifePlugin/0.1")
+Q_DECLARE_INTERFACE(LifePlugin, "com.jlarocco.LifePlugin/0.3")
 
 #endif
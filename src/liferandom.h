@@ -0,0 +1,106 @@
+/*
+  liferandom.h
+
+  Copyright (c) 2011, Jeremiah LaRocco jeremiah.larocco@gmail.com
+
+  Permission to use, copy, modify, and/or distribute this software for any
+  purpose with or without fee is hereby granted, provided that the above
+  copyright notice and this permission notice appear in all copies.
+
+  THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+  WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+  MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+  ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+  WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+  ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+  OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+
+#ifndef LIFE_RANDOM_H
+#define LIFE_RANDOM_H
+
+#include <stdint.h>
+#include <time.h>
+
+// The splitmix64 finalizer; nearby inputs give unrelated hashes
+inline uint64_t lifeMix64(uint64_t x) {
+    x ^= x >> 30;
+    x *= 0xbf58476d1ce4e5b9ULL;
+    x ^= x >> 27;
+    x *= 0x94d049bb133111ebULL;
+    x ^= x >> 31;
+    return x;
+}
+
+// A seed that differs from run to run, and from call to call
+inline uint64_t lifeNewSeed() {
+    static uint64_t calls = 0;
+    ++calls;
+    uint64_t seed = lifeMix64((uint64_t(time(0)) << 20) ^ uint64_t(clock()) ^ (calls << 48));
+    // 0 means "pick a new seed" in the plugin settings
+    return seed ? seed : 1;
+}
+
+/*
+  Counter based random numbers: word n of a stream is a hash of the seed
+  and n, so any part of a board can be filled on any thread, in any
+  order, and the same seed always gives the same board.
+*/
+class LifeRandom {
+public:
+    explicit LifeRandom(uint64_t seed) : key(lifeMix64(seed)) {}
+
+    uint64_t word(uint64_t n) const {
+        return lifeMix64(key + n*0x9e3779b97f4a7c15ULL);
+    }
+
+private:
+    uint64_t key;
+};
+
+/*
+  Words of cells that are each alive with probability p, rounded to a
+  multiple of 1/65536.  Each output word combines one random word per bit
+  of p, starting from the least significant set bit: OR-ing in a random
+  word takes the probability a bit is set from q to (1+q)/2, and AND-ing
+  takes it to q/2, so walking up p's bits ends with exactly p.
+*/
+class LifeBernoulli {
+public:
+    static const int PRECISION = 16;
+
+    LifeBernoulli(uint64_t seed, double p) : random(seed), fraction(0), lowBit(0) {
+        double scaled = p*(1 << PRECISION) + 0.5;
+        if (scaled >= double(1 << PRECISION)) {
+            fraction = 1 << PRECISION;
+        } else if (scaled >= 1.0) {
+            fraction = unsigned(scaled);
+            while (!((fraction >> lowBit) & 1)) {
+                ++lowBit;
+            }
+        }
+    }
+
+    // Cell word n of the stream
+    uint64_t word(uint64_t n) const {
+        if (fraction == 0) {
+            return 0;
+        }
+        if (fraction >> PRECISION) {
+            return ~uint64_t(0);
+        }
+        uint64_t result = 0;
+        for (int b=lowBit; b<PRECISION; ++b) {
+            uint64_t r = random.word(n*PRECISION + b);
+            result = ((fraction >> b) & 1) ? (result | r) : (result & r);
+        }
+        return result;
+    }
+
+private:
+    LifeRandom random;
+    unsigned int fraction;
+    int lowBit;
+};
+
+#endif
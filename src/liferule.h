@@ -0,0 +1,238 @@
+/*
+  liferule.h
+
+  Copyright (c) 2011, Jeremiah LaRocco jeremiah.larocco@gmail.com
+
+  Permission to use, copy, modify, and/or distribute this software for any
+  purpose with or without fee is hereby granted, provided that the above
+  copyright notice and this permission notice appear in all copies.
+
+  THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+  WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+  MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+  ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+  WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+  ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+  OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+
+#ifndef LIFE_RULE_H
+#define LIFE_RULE_H
+
+#include <string>
+
+/*
+  An outer totalistic rule.  Bit n of birth is set when a dead cell with n
+  live neighbors comes to life, bit n of survive when a live cell with n
+  neighbors stays alive.  Rules are written as rulestrings like "B3/S23";
+  the older survival/birth form "23/3" is read as well.
+*/
+struct LifeRule {
+    // Rules with their own compiled kernels, anything else is Generic
+    enum Kind {
+        Conway = 0,
+        HighLife,
+        DayAndNight,
+        Seeds,
+        Generic,
+        NumKinds
+    };
+
+    unsigned int birth;
+    unsigned int survive;
+
+    LifeRule() : birth(1 << 3), survive((1 << 2) | (1 << 3)) {}
+    LifeRule(unsigned int b, unsigned int s) : birth(b), survive(s) {}
+
+    bool next(bool alive, int num) const {
+        return ((alive ? survive : birth) >> num) & 1;
+    }
+
+    bool operator==(const LifeRule &other) const {
+        return birth == other.birth && survive == other.survive;
+    }
+    bool operator!=(const LifeRule &other) const {
+        return !(*this == other);
+    }
+
+    inline Kind kind() const;
+    inline bool parse(const char *text, int maxNeighbors = 8);
+    inline std::string toString() const;
+};
+
+/*
+  Kernels are templates over a rule type with next() for counted
+  neighbors and apply() for bit-sliced counts, where each argument holds
+  one bit of the neighbor count for every cell in the word or vector.
+  FixedRule has its masks as template arguments so the compiler folds the
+  rule into a handful of logic operations; MaskRule reads them at run time.
+*/
+template <unsigned int B, unsigned int S>
+struct FixedRule {
+    FixedRule() {}
+    FixedRule(const LifeRule &) {}
+
+    bool next(bool alive, int num) const {
+        return (((alive ? S : B) >> num) & 1) != 0;
+    }
+
+    template <class T>
+    T apply(T ones, T twos, T fours, T eights, T alive) const {
+        return term<0>(ones, twos, fours, eights, alive) |
+            term<1>(ones, twos, fours, eights, alive) |
+            term<2>(ones, twos, fours, eights, alive) |
+            term<3>(ones, twos, fours, eights, alive) |
+            term<4>(ones, twos, fours, eights, alive) |
+            term<5>(ones, twos, fours, eights, alive) |
+            term<6>(ones, twos, fours, eights, alive) |
+            term<7>(ones, twos, fours, eights, alive) |
+            term<8>(ones, twos, fours, eights, alive);
+    }
+
+private:
+    // Cells with exactly N neighbors that are alive next generation
+    template <int N, class T>
+    T term(T ones, T twos, T fours, T eights, T alive) const {
+        const bool born = (B >> N) & 1;
+        const bool stays = (S >> N) & 1;
+        if (!born && !stays) {
+            return alive & ~alive;
+        }
+        T count = ((N & 1) ? ones : ~ones) & ((N & 2) ? twos : ~twos) &
+            ((N & 4) ? fours : ~fours) & ((N & 8) ? eights : ~eights);
+        if (born && stays) {
+            return count;
+        }
+        return born ? (count & ~alive) : (count & alive);
+    }
+};
+
+// B3/S23 by hand: two or three neighbors, and either three or already alive
+struct ConwayRule {
+    ConwayRule() {}
+    ConwayRule(const LifeRule &) {}
+
+    bool next(bool alive, int num) const {
+        return num == 3 || (alive && num == 2);
+    }
+
+    template <class T>
+    T apply(T ones, T twos, T fours, T, T alive) const {
+        return twos & ~fours & (ones | alive);
+    }
+};
+
+typedef FixedRule<(1 << 3) | (1 << 6), (1 << 2) | (1 << 3)> HighLifeRule;
+typedef FixedRule<(1 << 3) | (1 << 6) | (1 << 7) | (1 << 8),
+                  (1 << 3) | (1 << 4) | (1 << 6) | (1 << 7) | (1 << 8)> DayAndNightRule;
+typedef FixedRule<(1 << 2), 0> SeedsRule;
+
+struct MaskRule {
+    MaskRule(const LifeRule &rule) : birth(rule.birth), survive(rule.survive) {}
+
+    bool next(bool alive, int num) const {
+        return ((alive ? survive : birth) >> num) & 1;
+    }
+
+    template <class T>
+    T apply(T ones, T twos, T fours, T eights, T alive) const {
+        T result = alive & ~alive;
+        for (int n=0; n<=8; ++n) {
+            bool born = (birth >> n) & 1;
+            bool stays = (survive >> n) & 1;
+            if (!born && !stays) {
+                continue;
+            }
+            T count = ((n & 1) ? ones : ~ones) & ((n & 2) ? twos : ~twos) &
+                ((n & 4) ? fours : ~fours) & ((n & 8) ? eights : ~eights);
+            if (born && stays) {
+                result = result | count;
+            } else if (born) {
+                result = result | (count & ~alive);
+            } else {
+                result = result | (count & alive);
+            }
+        }
+        return result;
+    }
+
+    unsigned int birth;
+    unsigned int survive;
+};
+
+LifeRule::Kind LifeRule::kind() const {
+    if (*this == LifeRule()) {
+        return Conway;
+    }
+    if (*this == LifeRule((1 << 3) | (1 << 6), (1 << 2) | (1 << 3))) {
+        return HighLife;
+    }
+    if (*this == LifeRule((1 << 3) | (1 << 6) | (1 << 7) | (1 << 8),
+                          (1 << 3) | (1 << 4) | (1 << 6) | (1 << 7) | (1 << 8))) {
+        return DayAndNight;
+    }
+    if (*this == LifeRule(1 << 2, 0)) {
+        return Seeds;
+    }
+    return Generic;
+}
+
+// Leaves the rule alone and returns false if text isn't a valid rulestring
+bool LifeRule::parse(const char *text, int maxNeighbors) {
+    unsigned int masks[2] = { 0, 0 };
+    bool letters = false;
+    for (const char *c = text; *c; ++c) {
+        if (*c == 'B' || *c == 'b' || *c == 'S' || *c == 's') {
+            letters = true;
+        }
+    }
+
+    // With letters each digit goes to the last B or S, otherwise the
+    // digits before the slash are survival and the ones after are birth
+    int which = letters ? -1 : 1;
+    int slashes = 0;
+    for (const char *c = text; *c; ++c) {
+        if (*c == 'B' || *c == 'b') {
+            which = 0;
+        } else if (*c == 'S' || *c == 's') {
+            which = 1;
+        } else if (*c == '/') {
+            ++slashes;
+            if (!letters) {
+                which = 0;
+            }
+        } else if (*c >= '0' && *c <= '9') {
+            int n = *c - '0';
+            if (which < 0 || n > maxNeighbors) {
+                return false;
+            }
+            masks[which] |= 1u << n;
+        } else if (*c != ' ' && *c != '\t') {
+            return false;
+        }
+    }
+    if (slashes > 1 || (!letters && slashes != 1)) {
+        return false;
+    }
+    birth = masks[0];
+    survive = masks[1];
+    return true;
+}
+
+std::string LifeRule::toString() const {
+    std::string text("B");
+    for (int n=0; n<=9; ++n) {
+        if ((birth >> n) & 1) {
+            text += char('0' + n);
+        }
+    }
+    text += "/S";
+    for (int n=0; n<=9; ++n) {
+        if ((survive >> n) & 1) {
+            text += char('0' + n);
+        }
+    }
+    return text;
+}
+
+#endif
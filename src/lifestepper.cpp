@@ -0,0 +1,57 @@
+/*
+  lifestepper.cpp
+  
+  Copyright (c) 2011, Jeremiah LaRocco jeremiah.larocco@gmail.com
+
+  Permission to use, copy, modify, and/or distribute this software for any
+  purpose with or without fee is hereby granted, provided that the above
+  copyright notice and this permission notice appear in all copies.
+
+  THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+  WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+  MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+  ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+  WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+  ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+  OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+
+#include <QTime>
+
+#include "lifestepper.h"
+
+LifeStepper::LifeStepper(LifePlugin *plug, QMutex *mutex, qint64 num,
+                         QObject *parent) : QThread(parent),
+                                            plugin(plug),
+                                            lock(mutex),
+                                            count(num),
+                                            generations(0),
+                                            cancelled(0) {
+}
+
+void LifeStepper::cancel() {
+    cancelled.fetchAndStoreOrdered(1);
+}
+
+void LifeStepper::run() {
+    QTime clock;
+    clock.start();
+    int lastReport = 0;
+
+    while (generations < count && cancelled == 0) {
+        lock->lock();
+        bool done = plugin->evolve();
+        generations += plugin->generationsPerStep();
+        lock->unlock();
+        if (done) {
+            break;
+        }
+        // Only report every 50ms so the progress dialog doesn't flood the
+        // event loop on fast engines
+        if (clock.elapsed() - lastReport >= 50) {
+            lastReport = clock.elapsed();
+            emit progress(int(1000.0*qMin(generations, count)/count));
+        }
+    }
+    emit progress(int(1000.0*qMin(generations, count)/count));
+}
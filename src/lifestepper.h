@@ -0,0 +1,63 @@
+/*
+  lifestepper.h
+  
+  Copyright (c) 2011, Jeremiah LaRocco jeremiah.larocco@gmail.com
+
+  Permission to use, copy, modify, and/or distribute this software for any
+  purpose with or without fee is hereby granted, provided that the above
+  copyright notice and this permission notice appear in all copies.
+
+  THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+  WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+  MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+  ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+  WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+  ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+  OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+
+#ifndef LIFE_STEPPER_INCLUDE_H
+#define LIFE_STEPPER_INCLUDE_H
+
+#include <QThread>
+#include <QAtomicInt>
+#include <QMutex>
+
+#include "lifeplugin.h"
+
+/*
+  Evolves a plugin a number of generations in a tight loop on its own
+  thread, without drawing, holding lock while each generation evolves.
+  Stops early when cancelled or when evolve() returns true.  Plugins that
+  evolve several generations per step can go past count by less than a
+  step.
+*/
+class LifeStepper : public QThread {
+    Q_OBJECT;
+
+public:
+    LifeStepper(LifePlugin *plugin, QMutex *lock, qint64 count, QObject *parent = 0);
+
+    // Generations actually evolved, valid once the thread has finished
+    qint64 generationsDone() const { return generations; }
+
+public slots:
+    // Safe to call from any thread
+    void cancel();
+
+signals:
+    // Emitted a few times a second with how far along it is, out of 1000
+    void progress(int permille);
+
+protected:
+    void run();
+
+private:
+    LifePlugin *plugin;
+    QMutex *lock;
+    qint64 count;
+    qint64 generations;
+    QAtomicInt cancelled;
+};
+
+#endif
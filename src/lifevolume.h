@@ -0,0 +1,157 @@
+/*
+  lifevolume.h
+  
+  Copyright (c) 2011, Jeremiah LaRocco jeremiah.larocco@gmail.com
+
+  Permission to use, copy, modify, and/or distribute this software for any
+  purpose with or without fee is hereby granted, provided that the above
+  copyright notice and this permission notice appear in all copies.
+
+  THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+  WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+  MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+  ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+  WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+  ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+  OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+
+#ifndef LIFE_VOLUME_H
+#define LIFE_VOLUME_H
+
+#include <QtGlobal>
+
+#include <string.h>
+#include <stdint.h>
+
+/*
+  A width x height x depth volume of cells packed 64 to a word along x.
+  Each z slab is height rows of words() words, laid out like a BitBoard,
+  and the slabs follow each other in one cache line aligned block, so
+  neighbor passes can stream through the volume a slab at a time.  Unused
+  bits in the last word of each row are always zero.
+*/
+class LifeVolume {
+public:
+    LifeVolume() : w(0), h(0), d(0), wpr(0), allocs(0), size(0), bits(0) {}
+    ~LifeVolume() {
+        qFreeAligned(bits);
+    }
+
+    // Clears the volume, only allocating when it grows
+    void resize(int width, int height, int depth) {
+        w = width;
+        h = height;
+        d = depth;
+        wpr = (w+63)/64;
+        size_t words = size_t(wpr)*h*d;
+        if (words > size || !bits) {
+            qFreeAligned(bits);
+            bits = static_cast<uint64_t *>(qMallocAligned(qMax(words, size_t(1))*sizeof(uint64_t), 64));
+            size = words;
+            ++allocs;
+        }
+        clear();
+    }
+
+    void clear() {
+        memset(bits, 0, size_t(wpr)*h*d*sizeof(uint64_t));
+    }
+
+    void swap(LifeVolume &other) {
+        qSwap(w, other.w);
+        qSwap(h, other.h);
+        qSwap(d, other.d);
+        qSwap(wpr, other.wpr);
+        qSwap(allocs, other.allocs);
+        qSwap(size, other.size);
+        qSwap(bits, other.bits);
+    }
+
+    int width() const { return w; }
+    int height() const { return h; }
+    int depth() const { return d; }
+
+    // Words in a row, and in a slab
+    int words() const { return wpr; }
+    size_t slabWords() const { return size_t(wpr)*h; }
+
+    // Number of times the buffer has been allocated
+    int allocations() const { return allocs; }
+    size_t bytes() const { return size*sizeof(uint64_t); }
+
+    uint64_t *row(int y, int z) {
+        return bits + (size_t(z)*h + y)*wpr;
+    }
+    const uint64_t *row(int y, int z) const {
+        return bits + (size_t(z)*h + y)*wpr;
+    }
+    uint64_t *slab(int z) {
+        return bits + size_t(z)*h*wpr;
+    }
+    const uint64_t *slab(int z) const {
+        return bits + size_t(z)*h*wpr;
+    }
+
+    bool get(int x, int y, int z) const {
+        return (row(y, z)[x>>6] >> (x&63)) & 1;
+    }
+    void set(int x, int y, int z, bool alive) {
+        uint64_t bit = uint64_t(1) << (x&63);
+        if (alive) {
+            row(y, z)[x>>6] |= bit;
+        } else {
+            row(y, z)[x>>6] &= ~bit;
+        }
+    }
+
+    // Bits of the last word of a row that hold cells
+    uint64_t lastMask() const {
+        return (w & 63) ? (uint64_t(1) << (w & 63)) - 1 : ~uint64_t(0);
+    }
+
+    // Word k of a row shifted so that bit n holds the neighbor at x-1 or
+    // x+1, wrapping around the ends of the row.  Bits past the end of the
+    // row are garbage and have to be masked off.
+    uint64_t westWord(const uint64_t *cells, int k) const {
+        uint64_t carry = k > 0 ? cells[k-1] >> 63 : (cells[(w-1)>>6] >> ((w-1)&63)) & 1;
+        return (cells[k] << 1) | carry;
+    }
+    uint64_t eastWord(const uint64_t *cells, int k) const {
+        uint64_t word = cells[k] >> 1;
+        if (k < wpr-1) {
+            return word | (cells[k+1] << 63);
+        }
+        return word | ((cells[0] & 1) << ((w-1)&63));
+    }
+
+    uint64_t slabPopulation(int z) const {
+        const uint64_t *cells = slab(z);
+        size_t words = slabWords();
+        uint64_t total = 0;
+        for (size_t k=0; k<words; ++k) {
+            total += __builtin_popcountll(cells[k]);
+        }
+        return total;
+    }
+
+    uint64_t population() const {
+        uint64_t total = 0;
+        for (int z=0; z<d; ++z) {
+            total += slabPopulation(z);
+        }
+        return total;
+    }
+
+private:
+    LifeVolume(const LifeVolume &);
+    LifeVolume &operator=(const LifeVolume &);
+
+    int w, h, d;
+    int wpr;
+    int allocs;
+    size_t size;
+    uint64_t *bits;
+};
+
+#endif
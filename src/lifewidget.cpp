@@ -19,25 +19,81 @@
 #include <QMainWindow>
 
 #include "lifewidget.h"
+#include "lifestepper.h"
+#include "lifeengine.h"
 
 #include <cmath>
 
 #define PI (3.141592654)
 
-LifeWidget::LifeWidget(LifePlugin *plug, QWidget *parent) : QGLWidget(parent), curPlugin(plug), curIter(0) {
+// Least share of the time left for drawing when the engine can't keep up
+static const double MIN_DRAW_SHARE = 0.25;
+
+LifeWidget::LifeWidget(LifePlugin *plug, QWidget *parent) : QGLWidget(parent),
+                                                            frameMs(FRAME_MS), drawMs(0),
+                                                            rateGens(0), rateFrames(0),
+                                                            genRate(0), fps(0),
+                                                            curPlugin(plug), curIter(0),
+                                                            stepper(0), stepProgress(0) {
     setFormat(QGLFormat(QGL::DoubleBuffer | QGL::DepthBuffer // | QGL::SampleBuffers
                         | QGL::AlphaChannel | QGL::DirectRendering));
 
+    // paintGL() swaps only when it drew, so a frame skipped while the
+    // engine is busy keeps showing the last one
+    setAutoBufferSwap(false);
+
     connect(&timer, SIGNAL(timeout()), this, SLOT(timeout()));
 
+    engine = new LifeEngine(this);
+    engine->setPlugin(curPlugin);
+    connect(engine, SIGNAL(frameReady()), this, SLOT(drawFrame()));
+    connect(engine, SIGNAL(stopped()), this, SLOT(engineStopped()));
+    engine->start();
+}
+
+LifeWidget::~LifeWidget() {
+    if (stepper) {
+        stepper->cancel();
+        stepper->wait();
+    }
+    delete engine;
+    if (curPlugin) {
+        makeCurrent();
+        curPlugin->releaseView();
+    }
 }
 
 void LifeWidget::setPlugin(LifePlugin *newPlugin) {
     // What needs clean up?
+    stop();
+    if (stepper) {
+        // The fast forward belongs to the old plugin; it takes the plugin
+        // lock each generation, so wait for it before taking it here
+        stepper->disconnect(this);
+        stepper->cancel();
+        stepper->wait();
+        stepFinished();
+    }
+    QMutexLocker locker(engine->pluginMutex());
+    makeCurrent();
+    if (curPlugin) {
+        curPlugin->releaseView();
+    }
     curPlugin = newPlugin;
+    engine->setPlugin(curPlugin);
+    curIter = 0;
     curPlugin->reset();
     curPlugin->initView();
     curPlugin->resizeView(curWidth, curHeight);
+    curInfo = curPlugin->engineInfo();
+}
+
+void LifeWidget::setRate(int gensPerSecond) {
+    engine->setRate(gensPerSecond);
+}
+
+int LifeWidget::rate() {
+    return engine->rate();
 }
 
 // void LifeWidget::configure() {
@@ -45,15 +101,58 @@ void LifeWidget::setPlugin(LifePlugin *newPlugin) {
 // }
 
 void LifeWidget::timeout() {
-    if (curPlugin) {
-        curIter++;
-        bool done = curPlugin->evolve();
-        if (done) {
-            stop();
-        }
-        emit iterationDone(curIter);
+    publish();
+    measureRates();
+    schedule();
+}
+
+// Shows the generations the engine evolved since the last frame, if any
+void LifeWidget::publish() {
+    qint64 gens = engine->takeGenerations();
+    if (gens == 0) {
+        return;
     }
+    curIter += gens;
+    rateGens += gens;
     updateGL();
+    emit iterationDone(curIter);
+}
+
+// The engine stopped between generations for a frame
+void LifeWidget::drawFrame() {
+    updateGL();
+    engine->frameDone();
+}
+
+void LifeWidget::engineStopped() {
+    stop();
+}
+
+void LifeWidget::measureRates() {
+    qint64 elapsed = rateClock.elapsed();
+    if (elapsed < RATE_WINDOW_MS) {
+        return;
+    }
+    genRate = rateGens*1000.0/elapsed;
+    fps = rateFrames*1000.0/elapsed;
+    rateGens = rateFrames = 0;
+    rateClock.restart();
+}
+
+/*
+  Frames are FRAME_MS apart and show however many generations the engine
+  finished in between.  The engine waits while a frame is drawn, so when
+  evolving at the target rate doesn't leave time to draw every frame,
+  frames are spread out so drawing only takes the time that is left.  An
+  unthrottled or overloaded engine still leaves MIN_DRAW_SHARE of the time
+  to drawing, so the view never freezes.
+*/
+void LifeWidget::schedule() {
+    int target = engine->rate();
+    double evolveShare = target > 0 ? engine->evolveMillis()*target/1000 : 1.0;
+    double drawShare = qMax(1.0 - evolveShare, MIN_DRAW_SHARE);
+    frameMs = qBound(double(FRAME_MS), drawMs/drawShare, double(MAX_FRAME_MS));
+    timer.setInterval(int(frameMs));
 }
 
 void LifeWidget::initializeGL() {
@@ -82,30 +181,100 @@ void LifeWidget::resizeGL(int width, int height) {
 }
 
 void LifeWidget::paintGL() {
+    if (stepper) {
+        // The plugin is being evolved on another thread, keep the last frame
+        return;
+    }
+    if (!engine->pluginMutex()->tryLock()) {
+        // Mid generation; the engine hands over once it's done with it
+        engine->requestFrame();
+        return;
+    }
+    QElapsedTimer clock;
+    clock.start();
     if (curPlugin) {
         curPlugin->draw();
+        curInfo = curPlugin->engineInfo();
     } else {
         glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
         glFlush();
     }
+    engine->pluginMutex()->unlock();
+    swapBuffers();
+
+    // Smoothed over the last several frames
+    drawMs += (clock.nsecsElapsed()*1e-6 - drawMs)/8;
+    ++rateFrames;
 }
 void LifeWidget::stop() {
+    engine->pause();
+    // Wait out the generation in progress so the plugin is left alone
+    engine->pluginMutex()->lock();
+    engine->pluginMutex()->unlock();
     timer.stop();
+    genRate = fps = 0;
+    publish();
+    emit iterationDone(curIter);
 }
 void LifeWidget::start() {
-    timer.start(1000/100);
+    if (stepper || !curPlugin) return;
+    rateGens = rateFrames = 0;
+    rateClock.start();
+    timer.start(int(frameMs));
+    engine->resume();
 }
 void LifeWidget::reset() {
+    if (stepper) return;
     if (curPlugin) {
+        QMutexLocker locker(engine->pluginMutex());
         curIter = 0;
         curPlugin->reset();
-        emit iterationDone(curIter);
+        curInfo = curPlugin->engineInfo();
+        engine->takeGenerations();
     }
     updateGL();
+    emit iterationDone(curIter);
+}
+
+void LifeWidget::stepGenerations(qint64 count) {
+    if (!curPlugin || stepper || count <= 0) return;
+
+    stop();
+
+    stepProgress = new QProgressDialog(tr("Evolving %1 generations...").arg(count),
+                                       tr("Cancel"), 0, 1000, this);
+    stepProgress->setWindowModality(Qt::WindowModal);
+    stepProgress->setMinimumDuration(500);
+
+    stepper = new LifeStepper(curPlugin, engine->pluginMutex(), count, this);
+    connect(stepper, SIGNAL(progress(int)), stepProgress, SLOT(setValue(int)));
+    // Direct so cancelling doesn't wait on the stepper's (busy) thread
+    connect(stepProgress, SIGNAL(canceled()), stepper, SLOT(cancel()), Qt::DirectConnection);
+    connect(stepper, SIGNAL(finished()), this, SLOT(stepFinished()));
+    stepper->start();
+    emit steppingChanged(true);
+}
+
+void LifeWidget::stepFinished() {
+    // Already cleaned up if setPlugin() cancelled it
+    if (!stepper) return;
+
+    curIter += stepper->generationsDone();
+
+    stepper->deleteLater();
+    stepper = 0;
+    stepProgress->deleteLater();
+    stepProgress = 0;
+
+    updateGL();
+    emit iterationDone(curIter);
+    emit steppingChanged(false);
 }
 
 void LifeWidget::resetView() {
     if (curPlugin) {
+        makeCurrent();
+        curPlugin->releaseView();
         curPlugin->initView();
         updateGL();
     }
@@ -160,9 +329,10 @@ void LifeWidget::mouseMoveEvent(QMouseEvent *event) {
 
     rotating = true;
 
-    // Rotate depending on which mouse button is clicked
+    // Rotate depending on which mouse button is clicked, 2D plugins pan
     if (event->buttons() & Qt::LeftButton) {
         curPlugin->rotate(180*dy, 180*dx, 0);
+        curPlugin->pan(dx, dy);
     } else if (event->buttons() & Qt::RightButton) {
         curPlugin->rotate(180*dy, 0, 180*dx);
     }
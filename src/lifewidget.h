@@ -30,23 +30,45 @@
 
 #include "lifeplugin.h"
 
+class QProgressDialog;
+class LifeStepper;
+class LifeEngine;
+
 class LifeWidget : public QGLWidget {
     Q_OBJECT;
 
 public:
     LifeWidget(LifePlugin *curPlugin=0, QWidget *parent = 0);
+    ~LifeWidget();
 
     void setPlugin(LifePlugin *newPlugin);
 
+    qint64 iteration() const { return curIter; }
+
+    // The plugin's engineInfo() as of the last frame drawn
+    QString engineInfo() const { return curInfo; }
+
+    // Generations per second, 0 for as fast as possible
+    void setRate(int gensPerSecond);
+    int rate();
+
+    // Generations and frames per second actually shown while running
+    double achievedRate() const { return genRate; }
+    double frameRate() const { return fps; }
+
 public slots:
     void stop();
     void start();
     void reset();
     void resetView();
+    // Evolves count generations off the GUI thread and repaints once at the end
+    void stepGenerations(qint64 count);
     /* void configure(); */
 
 signals:
-    void iterationDone(int);
+    void iterationDone(qint64);
+    // The plugin mustn't be changed while a fast forward is running
+    void steppingChanged(bool stepping);
 
 protected:
     void initializeGL();
@@ -60,13 +82,41 @@ protected:
         
 private slots:
     void timeout();
+    void drawFrame();
+    void engineStopped();
+    void stepFinished();
 
 private:
+    void publish();
+    void measureRates();
+    void schedule();
+
+    // Checks for new generations at display rate, every frameMs
     QTimer timer;
+    double frameMs;
+    double drawMs;
+
+    static const int FRAME_MS = 16;
+    static const int MAX_FRAME_MS = 250;
+
+    // Rates are measured over about RATE_WINDOW_MS
+    static const int RATE_WINDOW_MS = 500;
+    QElapsedTimer rateClock;
+    qint64 rateGens;
+    int rateFrames;
+    double genRate, fps;
     LifePlugin *curPlugin;
 
+    // Evolves curPlugin while running
+    LifeEngine *engine;
+
     int curWidth, curHeight;
-    int curIter;
+    qint64 curIter;
+    QString curInfo;
+
+    // Running fast forward, if any; the plugin belongs to it until it finishes
+    LifeStepper *stepper;
+    QProgressDialog *stepProgress;
 
     // Stores last mouse position for rotation
     QPoint lastPos;
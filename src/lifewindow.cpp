@@ -18,20 +18,31 @@
 
 #include <QtGui>
 #include <stdexcept>
+#include <climits>
 #include "lifewindow.h"
 
+// Largest generation the jump dialog can enter exactly
+static const double MAX_GENERATION = 9007199254740992.0;
+
 void LifeWindow::readSettings() {
   settings = new QSettings(QSettings::IniFormat, QSettings::UserScope,
                            "Life", "Life");
-    
+
+  // Plugins evolve their boards in bands on the global pool; keep the
+  // threads alive between generations instead of letting them expire
+  QThreadPool::globalInstance()->setExpiryTimeout(-1);
+  QThreadPool::globalInstance()->setMaxThreadCount(
+      settings->value("worker_threads", QThread::idealThreadCount()).toInt());
 }
 
 LifeWindow::LifeWindow(QWidget *parent) : QMainWindow(parent) {
     readSettings();
 
     life = new LifeWidget;
+    life->setRate(settings->value("generations_per_second", 0).toInt());
     setCentralWidget(life);
-    connect(life, SIGNAL(iterationDone(int)), this, SLOT(updateIteration(int)));
+    connect(life, SIGNAL(iterationDone(qint64)), this, SLOT(updateIteration(qint64)));
+    connect(life, SIGNAL(steppingChanged(bool)), this, SLOT(steppingChanged(bool)));
 
     loadPlugins();
 
@@ -58,6 +69,21 @@ void LifeWindow::setupActions() {
     stopAction->setStatusTip(tr("Stop iterating current life pattern"));
     connect(stopAction, SIGNAL(triggered()), life, SLOT(stop()));
 
+    // Fast forward without drawing
+    stepAction = new QAction(tr("Step..."), this);
+    stepAction->setShortcut(tr("Ctrl+N"));
+    stepAction->setStatusTip(tr("Evolve a number of generations without drawing them"));
+    connect(stepAction, SIGNAL(triggered()), this, SLOT(stepGenerations()));
+
+    jumpAction = new QAction(tr("Jump to Generation..."), this);
+    jumpAction->setShortcut(tr("Ctrl+J"));
+    jumpAction->setStatusTip(tr("Evolve up to a generation without drawing the ones in between"));
+    connect(jumpAction, SIGNAL(triggered()), this, SLOT(jumpToGeneration()));
+
+    speedAction = new QAction(tr("Speed..."), this);
+    speedAction->setStatusTip(tr("Set how many generations to evolve each second"));
+    connect(speedAction, SIGNAL(triggered()), this, SLOT(configureSpeed()));
+
     // Exit
     exitAction = new QAction(tr("Exit"), this);
     exitAction->setIcon(QIcon(":/images/exit.png"));
@@ -77,6 +103,11 @@ void LifeWindow::setupActions() {
     configureAction->setStatusTip(tr("Restart"));
     connect(configureAction, SIGNAL(triggered()), this, SLOT(configureCurrentPlugin()));
 
+    // Worker threads
+    threadsAction = new QAction(tr("Worker Threads..."), this);
+    threadsAction->setStatusTip(tr("Set the number of threads used to evolve"));
+    connect(threadsAction, SIGNAL(triggered()), this, SLOT(configureThreads()));
+
     // Reset view
     resetViewAction = new QAction(tr("Reset View"), this);
     resetViewAction->setIcon(QIcon(":/images/resetview.png"));
@@ -108,6 +139,10 @@ void LifeWindow::setupMenuBar() {
     fileMenu->addAction(resetAction);
     fileMenu->addAction(resetViewAction);
     fileMenu->addSeparator();
+    fileMenu->addAction(stepAction);
+    fileMenu->addAction(jumpAction);
+    fileMenu->addAction(speedAction);
+    fileMenu->addSeparator();
     fileMenu->addAction(exitAction);
 
     pluginMenu = menuBar()->addMenu(tr("Type"));
@@ -118,9 +153,11 @@ void LifeWindow::setupMenuBar() {
         temp->setStatusTip(iter.value()->description());
         connect(temp, SIGNAL(triggered()), this, SLOT(pluginChanged()));
         pluginMenu->addAction(temp);
+        pluginActions << temp;
     }
     pluginMenu->addSeparator();
     pluginMenu->addAction(configureAction);
+    pluginMenu->addAction(threadsAction);
   
     menuBar()->addSeparator();
   
@@ -129,7 +166,89 @@ void LifeWindow::setupMenuBar() {
 }
 
 void LifeWindow::configureCurrentPlugin() {
+    // Configure dialogs change the plugin from this thread without its
+    // lock, so the engine stays stopped and the plugin stays current until
+    // they close
+    life->stop();
     plugins[curPlugin]->configure(this, settings);
+    foreach (QDialog *dialog, findChildren<QDialog *>()) {
+        if (dialog->isVisible()) {
+            setPluginActionsEnabled(false);
+            connect(dialog, SIGNAL(finished(int)), this, SLOT(configureFinished()),
+                    Qt::UniqueConnection);
+        }
+    }
+}
+
+void LifeWindow::configureFinished() {
+    setPluginActionsEnabled(true);
+}
+
+// The stepper evolves the plugin on its own thread, so nothing else may
+// change or replace it until it's done
+void LifeWindow::steppingChanged(bool stepping) {
+    setPluginActionsEnabled(!stepping);
+}
+
+void LifeWindow::setPluginActionsEnabled(bool enabled) {
+    startAction->setEnabled(enabled);
+    stepAction->setEnabled(enabled);
+    jumpAction->setEnabled(enabled);
+    configureAction->setEnabled(enabled);
+    foreach (QAction *action, pluginActions) {
+        action->setEnabled(enabled);
+    }
+}
+
+void LifeWindow::configureSpeed() {
+    bool ok = false;
+    int rate = QInputDialog::getInt(this, tr("Speed"),
+                                    tr("Generations per second (0 for as fast as possible):"),
+                                    life->rate(), 0, INT_MAX, 1, &ok);
+    if (!ok) return;
+
+    life->setRate(rate);
+    settings->setValue("generations_per_second", rate);
+    settings->sync();
+    updateSpeedLabel();
+}
+
+void LifeWindow::configureThreads() {
+    bool ok = false;
+    int threads = QInputDialog::getInt(this, tr("Worker Threads"),
+                                       tr("Threads used to evolve:"),
+                                       QThreadPool::globalInstance()->maxThreadCount(),
+                                       1, 1024, 1, &ok);
+    if (!ok) return;
+
+    QThreadPool::globalInstance()->setMaxThreadCount(threads);
+    settings->setValue("worker_threads", threads);
+    settings->sync();
+}
+
+void LifeWindow::stepGenerations() {
+    bool ok = false;
+    int count = QInputDialog::getInt(this, tr("Step"),
+                                     tr("Generations to evolve:"),
+                                     settings->value("step_count", 1000).toInt(),
+                                     1, INT_MAX, 1, &ok);
+    if (!ok) return;
+
+    settings->setValue("step_count", count);
+    life->stepGenerations(count);
+}
+
+void LifeWindow::jumpToGeneration() {
+    // Only forward, the plugins can't go back
+    // Taken as a double because HashLife steps can pass INT_MAX generations
+    bool ok = false;
+    qint64 current = life->iteration();
+    double target = QInputDialog::getDouble(this, tr("Jump to Generation"),
+                                            tr("Generation:"),
+                                            current + 1000, current + 1, MAX_GENERATION, 0, &ok);
+    if (!ok) return;
+
+    life->stepGenerations(qint64(target) - current);
 }
 
 void LifeWindow::setupStatusBar() {
@@ -146,10 +265,40 @@ void LifeWindow::setupStatusBar() {
     curPluginLabel->setMinimumWidth(fontMetrics().maxWidth()*10);
     curPluginLabel->setText(tr("Current Plugin: %1").arg(curPlugin));
     curPluginLabel->setAlignment(Qt::AlignHCenter);
+
+    speedLabel = new QLabel;
+    speedLabel->setMaximumWidth(fontMetrics().maxWidth()*24);
+    speedLabel->setMinimumWidth(fontMetrics().maxWidth()*10);
+    speedLabel->setAlignment(Qt::AlignHCenter);
+    updateSpeedLabel();
+
+    curEngineLabel = new QLabel;
+    curEngineLabel->setMaximumWidth(fontMetrics().maxWidth()*24);
+    curEngineLabel->setMinimumWidth(fontMetrics().maxWidth()*10);
+    curEngineLabel->setAlignment(Qt::AlignHCenter);
+    updateEngineLabel();
   
     statusBar()->addWidget(curIterLabel);
+    statusBar()->addWidget(speedLabel);
     statusBar()->addWidget(curPluginLabel);
+    statusBar()->addWidget(curEngineLabel);
+}
+
+void LifeWindow::updateEngineLabel() {
+    QString info;
+    if (plugins.contains(curPlugin)) {
+        info = life->engineInfo();
+    }
+    curEngineLabel->setText(tr("Engine: %1").arg(info.isEmpty() ? tr("default") : info));
 }
+void LifeWindow::updateSpeedLabel() {
+    QString target = life->rate() ? tr("%1").arg(life->rate()) : tr("max");
+    speedLabel->setText(tr("Speed: %1 gen/s (target %2), %3 fps")
+                        .arg(life->achievedRate(), 0, 'f', 0)
+                        .arg(target)
+                        .arg(life->frameRate(), 0, 'f', 0));
+}
+
 void LifeWindow::about() {
     QMessageBox::about(this,
                        tr("About"),
@@ -204,10 +353,13 @@ void LifeWindow::pluginChanged() {
     life->stop();
     life->setPlugin(plugins[curPlugin]);
 
-    curIterLabel->setText(tr("Current plugin: %1").arg(curPlugin));
-
+    curPluginLabel->setText(tr("Current Plugin: %1").arg(curPlugin));
+    updateEngineLabel();
 }
 
-void LifeWindow::updateIteration(int iter) {
+void LifeWindow::updateIteration(qint64 iter) {
     curIterLabel->setText(tr("Iteration: %1").arg(iter));
+    updateSpeedLabel();
+    // The engine can change from the plugin's configure dialog
+    updateEngineLabel();
 }
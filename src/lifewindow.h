@@ -45,7 +45,13 @@ public:
 public slots:
     void about();
     void configureCurrentPlugin();
-    void updateIteration(int iteration);
+    void configureThreads();
+    void configureSpeed();
+    void configureFinished();
+    void stepGenerations();
+    void jumpToGeneration();
+    void updateIteration(qint64 iteration);
+    void steppingChanged(bool stepping);
 
 /* private slots: */
 /*     void resetView(); */
@@ -64,6 +70,10 @@ private:
     void setupToolBar();
     void setupMenuBar();
     void setupStatusBar();
+    void updateEngineLabel();
+    void updateSpeedLabel();
+    // Everything that evolves, configures or replaces the current plugin
+    void setPluginActionsEnabled(bool enabled);
 
     void loadPlugins();
 
@@ -72,7 +82,11 @@ private:
     QAction *startAction;
     QAction *stopAction;
     QAction *resetAction;
+    QAction *stepAction;
+    QAction *jumpAction;
+    QAction *speedAction;
     QAction *configureAction;
+    QAction *threadsAction;
 
     QAction *resetViewAction;
     QAction *exitAction;
@@ -80,8 +94,11 @@ private:
 
     QLabel *curIterLabel;
     QLabel *curPluginLabel;
+    QLabel *speedLabel;
+    QLabel *curEngineLabel;
 
     QMap<QString, LifePlugin *> plugins;
+    QList<QAction *> pluginActions;
     QString curPlugin;
 
     QSettings *settings;
@@ -19,14 +19,18 @@
 #include <QApplication>
 #include <iostream>
 
-#include <cstdlib>
-#include <ctime>
-
 #include "lifewindow.h"
+#include "lifeheadless.h"
 
 int main(int argc, char *argv[]) {
+    // Compute nodes have no display, so headless runs never start QtGui
+    for (int i=1; i<argc; ++i) {
+        if (QString(argv[i]) == "--headless") {
+            QCoreApplication app(argc, argv);
+            return runHeadless();
+        }
+    }
 
-    std::srand(std::time(0));
     QApplication app(argc, argv);
     if (!QGLFormat::hasOpenGL()) {
         std::cerr << "This system has no OpenGL support" << std::endl;
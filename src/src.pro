@@ -10,9 +10,9 @@ QT += opengl
 
 DESTDIR       = ../bin
 
-HEADERS += lifeplugin.h lifewindow.h lifewidget.h
+HEADERS += lifeplugin.h lifewindow.h lifewidget.h lifestepper.h lifeengine.h lifeheadless.h
 
-SOURCES += main.cpp lifewindow.cpp lifewidget.cpp
+SOURCES += main.cpp lifewindow.cpp lifewidget.cpp lifestepper.cpp lifeengine.cpp lifeheadless.cpp
 
 RESOURCES += qlife.qrc
 